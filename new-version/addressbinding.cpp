@@ -44,6 +44,8 @@ void AddressBinding::findBindings()
                     {
                       entry.name = name;
                       entry.defined_in = E->getName();
+                      entry.defined_path = E->getPath();
+                      entry.defined_member = E->getMember();
                       entry.undefined_in.push_back(E->getName());
 
                       symbolTable[name] = entry;
@@ -54,10 +56,13 @@ void AddressBinding::findBindings()
 
                       entry.defined = true;
                       entry.defined_in = E->getName();
+                      entry.defined_path = E->getPath();
+                      entry.defined_member = E->getMember();
 
                       dec_value = bfd_asymbol_value(*current);
                       bfd_sprintf_vma(cur_bfd, buf, dec_value);
                       entry.def_value = buf;
+                      entry.def_vma = dec_value;
 
                       entry.defined_section = (*current)->section->name;
                       dec_value = bfd_asymbol_base(*current);
@@ -111,6 +116,8 @@ void AddressBinding::findBindings()
               dec_value = bfd_asymbol_value(*current);
               bfd_sprintf_vma(cur_bfd, buf, dec_value);
               entry.exe_value = buf;
+              entry.exe_vma = dec_value;
+              entry.placed = true;
 
               entry.section_name = (*current)->section->name;
 
@@ -133,6 +140,33 @@ void AddressBinding::findBindings()
     }
 }
 
+void AddressBinding::resolveShared(const SharedLibs &libs)
+{
+  std::vector<std::string> names;
+
+  for (auto it = this->symbolTable.begin(); it != this->symbolTable.end(); ++it)
+    if (!it->second.defined)
+      names.push_back(it->first);
+
+  std::vector<SharedSymbol> found = libs.lookupAll(names);
+  char buf[30];
+
+  for (size_t i = 0; i < names.size(); ++i)
+    {
+      if (!found[i].found)
+        continue;
+
+      Symbol &entry = this->symbolTable[names[i]];
+
+      snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long) found[i].value);
+
+      entry.provided_by = found[i].library;
+      entry.provider_path = found[i].path;
+      entry.provider_value = buf;
+      entry.provider_weak = found[i].weak;
+    }
+}
+
 std::vector<std::string> AddressBinding::getSymbols() const
 {
   std::vector<std::string> symbols;
@@ -155,6 +189,43 @@ Symbol AddressBinding::getSymbol(std::string symbolName) const
   return it->second;
 }
 
+const Symbol *AddressBinding::findSymbol(const std::string &symbolName) const
+{
+  auto it = symbolTable.find(symbolName);
+
+  return (it == symbolTable.end()) ? nullptr : &it->second;
+}
+
+std::unordered_map<asection *, bfd_vma> AddressBinding::placeSections(ELFFile *E) const
+{
+  std::unordered_map<asection *, bfd_vma> placed;
+  asymbol **current = E->getSyms();
+
+  for (long i = 0; i < E->getSymcount(); ++i, ++current)
+    {
+      asymbol *sym = *current;
+
+      // only the global names are bound to one definition
+      if (sym == NULL || (sym->flags & (BSF_GLOBAL | BSF_WEAK)) == 0
+          || (sym->flags & BSF_SECTION_SYM)
+          || bfd_is_und_section(sym->section)
+          || bfd_is_abs_section(sym->section)
+          || bfd_is_com_section(sym->section)
+          || placed.count(sym->section))
+        continue;
+
+      const Symbol *S = this->findSymbol(bfd_asymbol_name(sym));
+
+      if (S == nullptr || !S->placed || S->defined_in != E->getName()
+          || S->def_vma != bfd_asymbol_value(sym))
+        continue;
+
+      placed[sym->section] = S->exe_vma - sym->value;
+    }
+
+  return placed;
+}
+
 AddressBinding::AddressBinding()
 {
   exefile = nullptr;
@@ -7,6 +7,7 @@
 #include "symbol.h"
 #include "elffile.h"
 #include "tools.h"
+#include "sharedlibs.h"
 
 
 class AddressBinding
@@ -14,9 +15,20 @@ class AddressBinding
 public:
   void findBindings();
 
+  // finds the library providing each symbol no object defines
+  void resolveShared(const SharedLibs &);
+
   std::vector<std::string> getSymbols() const;
 
   Symbol getSymbol(std::string) const;
+  // the same without a copy, nullptr when the symbol isn't known; valid
+  // as long as the binding is
+  const Symbol *findSymbol(const std::string &) const;
+
+  // where the sections of an object were placed in the executable, from
+  // the global symbols it defines; a local name can belong to any object
+  // so it places nothing
+  std::unordered_map<asection *, bfd_vma> placeSections(ELFFile *) const;
 
   AddressBinding();
   AddressBinding(std::vector<ELFFile *>, ELFFile *);
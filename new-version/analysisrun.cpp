@@ -0,0 +1,126 @@
+#include "analysisrun.h"
+#include "disassemblemodule.h"
+#include "sharedlibs.h"
+
+void AnalysisListener::progress(std::string, std::string, int, int)
+{}
+
+void AnalysisListener::bindingReady()
+{}
+
+void AnalysisListener::fileDone(ELFFile *)
+{}
+
+AnalysisListener::~AnalysisListener()
+{}
+
+AnalysisRun::AnalysisRun(ELFFile *exe, std::vector<ELFFile *> objs, std::string root)
+  : exefile(exe), objfiles(objs), sysroot(root), AB(nullptr), FD(nullptr)
+{}
+
+AnalysisRun::~AnalysisRun()
+{
+  this->exefile = nullptr;
+  this->objfiles.clear();
+}
+
+std::vector<std::pair<ELFFile *, int> > AnalysisRun::getErrors() const
+{
+  return this->errors;
+}
+
+AddressBinding *AnalysisRun::getBinding() const
+{
+  return this->AB;
+}
+
+std::vector<std::vector<std::string> > AnalysisRun::getSymbolLists() const
+{
+  return this->symbolLists;
+}
+
+FunctionDiff *AnalysisRun::getDiff() const
+{
+  return this->FD;
+}
+
+int AnalysisRun::run(AnalysisListener *L, const std::atomic<bool> *cancel, FunctionChannel *channel)
+{
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+  AnalysisListener none;
+  int total = this->objfiles.size() + 1;
+  int errCode;
+
+  if (L == nullptr)
+    L = &none;
+
+  auto cancelled = [cancel]() { return cancel != nullptr && cancel->load(); };
+
+  // loading
+  L->progress("Loading", this->exefile->getName(), 0, total);
+
+  errCode = this->exefile->initBfd(ELF_EXE_FILE);
+  if (errCode)
+    this->errors.push_back(std::make_pair(this->exefile, errCode));
+
+  for (size_t i = 0; i < this->objfiles.size(); ++i)
+    {
+      if (cancelled())
+        return ANALYSIS_CANCELLED;
+
+      ELFFile *E = this->objfiles[i];
+
+      L->progress("Loading", E->getName(), i + 1, total);
+
+      errCode = E->initBfd(ELF_OBJ_FILE);
+      if (errCode)
+        this->errors.push_back(std::make_pair(E, errCode));
+    }
+
+  if (!this->errors.empty())
+    return ANALYSIS_FAILED;
+
+  // binding, the symbol lists are read here so the GUI doesn't use bfd
+  L->progress("Binding symbols", "", 0, 1);
+
+  this->AB = new AddressBinding(this->objfiles, this->exefile);
+
+  for (ELFFile *E : this->objfiles)
+    this->symbolLists.push_back(E->getSymbolList());
+
+  L->progress("Resolving shared libraries", "", 0, 1);
+
+  SharedLibs libs;
+
+  libs.load(this->exefile->getPath(), this->sysroot);
+  this->AB->resolveShared(libs);
+
+  L->bindingReady();
+
+  // disassembly, the executable first so its functions can be looked at
+  // while the rest is still being done
+  for (int i = -1; i < (int) this->objfiles.size(); ++i)
+    {
+      ELFFile *E = (i < 0) ? this->exefile : this->objfiles[i];
+
+      if (cancelled())
+        break;
+
+      L->progress("Disassembling", E->getName(), i + 1, total);
+
+      Disassembly::disassemble_data(E, cancel, channel);
+
+      // a file cut short isn't reported as done
+      if (!cancelled())
+        L->fileDone(E);
+    }
+
+  if (cancelled())
+    return ANALYSIS_CANCELLED;
+
+  L->progress("Comparing functions", "", 0, 1);
+
+  this->FD = new FunctionDiff(this->objfiles, this->exefile, this->AB);
+
+  return ANALYSIS_DONE;
+}
@@ -0,0 +1,70 @@
+#ifndef ANALYSISRUN_H
+#define ANALYSISRUN_H
+
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "elffile.h"
+#include "addressbinding.h"
+#include "functiondiff.h"
+#include "functionchannel.h"
+
+const int ANALYSIS_DONE = 0;
+const int ANALYSIS_CANCELLED = 1;
+const int ANALYSIS_FAILED = 2;
+
+// told about a run as it goes, from the thread running it
+class AnalysisListener
+{
+public:
+  virtual void progress(std::string phase, std::string file, int done, int total);
+
+  // the binding and the symbol lists can be read from now on
+  virtual void bindingReady();
+
+  // every function of a file has been disassembled
+  virtual void fileDone(ELFFile *);
+
+  virtual ~AnalysisListener();
+};
+
+// The steps of a project: load every file with bfd, bind the symbols and
+// resolve the rest against the needed libraries, disassemble the files,
+// the executable first, and compare the functions. The window and the
+// command line tool both run a project through here, so they find the
+// same things. bfd isn't thread safe, so nothing else may use the files
+// while run() goes.
+class AnalysisRun
+{
+public:
+  AnalysisRun(ELFFile *, std::vector<ELFFile *>, std::string);
+  ~AnalysisRun();
+
+  // returns ANALYSIS_DONE, ANALYSIS_CANCELLED or ANALYSIS_FAILED; *cancel*
+  // stops it at the next file or section, *channel* gets the functions
+  // as they are disassembled
+  int run(AnalysisListener *, const std::atomic<bool> * = nullptr,
+          FunctionChannel * = nullptr);
+
+  // files that couldn't be loaded and why, after ANALYSIS_FAILED
+  std::vector<std::pair<ELFFile *, int> > getErrors() const;
+
+  // the caller owns the binding and the diff
+  AddressBinding *getBinding() const;
+  // the symbols of every object, in the order of the objects
+  std::vector<std::vector<std::string> > getSymbolLists() const;
+  FunctionDiff *getDiff() const;
+
+private:
+  ELFFile *exefile;
+  std::vector<ELFFile *> objfiles;
+  std::string sysroot;
+
+  std::vector<std::pair<ELFFile *, int> > errors;
+  std::vector<std::vector<std::string> > symbolLists;
+  AddressBinding *AB;
+  FunctionDiff *FD;
+};
+
+#endif // ANALYSISRUN_H
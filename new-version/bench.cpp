@@ -0,0 +1,261 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#include "elfdetective.h"
+#include "functiontreemodel.h"
+#include "symbollistmodel.h"
+
+// the time of every phase of one run, in milliseconds
+struct PhaseTimes
+{
+  double load;
+  double bind;
+  double disassemble;
+  double populate;
+};
+
+static void print_usage()
+{
+  std::cerr << "Usage: elfdetective-bench [-j N] [-r RUNS] [-n NAME] [-o FILE]"
+            << " EXE OBJ...|@LIST" << std::endl
+            << "  -j N      worker threads, 0 for one per core" << std::endl
+            << "  -r RUNS   runs of every phase, the fastest is kept (3)" << std::endl
+            << "  -n NAME   name of the project in the results" << std::endl
+            << "  -o FILE   append the results there instead of stdout" << std::endl
+            << "  @LIST     a file with the path of an object on every line" << std::endl;
+}
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+
+  return d.count();
+}
+
+// fills the models the way the window does once a run is over: the
+// executable's symbols and functions, then the list of objects and the
+// functions of every object
+static void populate(AddressBinding *AB, ELFFile *exefile, const std::vector<ELFFile *> &objfiles)
+{
+  SymbolListModel exeSymbols;
+  FunctionTreeModel exeFunctions;
+  SymbolListModel objNames;
+  std::vector<FunctionTreeModel::Entry> functions;
+  std::vector<SymbolListModel::Entry> data;
+
+  for (const std::string &S : AB->getSymbols())
+    {
+      Symbol sym = AB->getSymbol(S);
+
+      if (sym.isUndefined() || sym.isVariable())
+        data.push_back(SymbolListModel::Entry{S, sym.provided_by});
+
+      if (sym.isFunction() && sym.isUndefined())
+        functions.push_back(FunctionTreeModel::Entry{sym.name, nullptr, sym.provided_by});
+    }
+
+  exeSymbols.setEntries(data);
+  exeFunctions.setEntries(functions);
+
+  // a row for every disassembled function the binding knows
+  auto entries = [AB](const std::vector<Function *> &found)
+    {
+      std::vector<FunctionTreeModel::Entry> rows;
+
+      for (Function *f : found)
+        if (!AB->getSymbol(f->getName()).isEmpty())
+          rows.push_back(FunctionTreeModel::Entry{f->getName(), f, ""});
+
+      return rows;
+    };
+
+  exeFunctions.insertEntries(0, entries(exefile->getFunctions()));
+
+  std::vector<SymbolListModel::Entry> names;
+
+  for (ELFFile *E : objfiles)
+    names.push_back(SymbolListModel::Entry{E->getName(), E->getPath()});
+
+  objNames.addEntries(names);
+
+  for (ELFFile *E : objfiles)
+    {
+      FunctionTreeModel objFunctions;
+
+      objFunctions.setEntries(entries(E->getFunctions()));
+    }
+}
+
+// one run of every phase over new files; false if a file can't be loaded
+static bool run_once(const std::string &exe, const std::vector<std::string> &objs, PhaseTimes *times)
+{
+  ELFFile *exefile = new ELFFile(exe);
+  std::vector<ELFFile *> objfiles;
+  bool loaded = true;
+
+  for (const std::string &path : objs)
+    objfiles.push_back(new ELFFile(path));
+
+  auto start = std::chrono::steady_clock::now();
+
+  if (exefile->initBfd(ELF_EXE_FILE))
+    {
+      std::cerr << exefile->getName() << " cannot be loaded" << std::endl;
+      loaded = false;
+    }
+
+  for (ELFFile *E : objfiles)
+    if (E->initBfd(ELF_OBJ_FILE))
+      {
+        std::cerr << E->getName() << " cannot be loaded" << std::endl;
+        loaded = false;
+      }
+
+  times->load = ms_since(start);
+
+  AddressBinding *AB = nullptr;
+
+  if (loaded)
+    {
+      start = std::chrono::steady_clock::now();
+      AB = new AddressBinding(objfiles, exefile);
+      times->bind = ms_since(start);
+
+      start = std::chrono::steady_clock::now();
+      Disassembly::disassemble_data(exefile);
+      for (ELFFile *E : objfiles)
+        Disassembly::disassemble_data(E);
+      times->disassemble = ms_since(start);
+
+      start = std::chrono::steady_clock::now();
+      populate(AB, exefile, objfiles);
+      times->populate = ms_since(start);
+    }
+
+  delete AB;
+
+  for (ELFFile *E : objfiles)
+    delete E;
+  delete exefile;
+
+  return loaded;
+}
+
+static bool read_list(const std::string &path, std::vector<std::string> &paths)
+{
+  std::ifstream in(path);
+  std::string line;
+
+  if (!in)
+    return false;
+
+  while (std::getline(in, line))
+    if (!line.empty())
+      paths.push_back(line);
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int runs = 3;
+  std::string name;
+  std::string output;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if ((arg == "-j" || arg == "-r" || arg == "-n" || arg == "-o") && i + 1 == argc)
+        {
+          print_usage();
+          return 2;
+        }
+
+      if (arg == "-j")
+        set_worker_count(strtoul(argv[++i], NULL, 10));
+      else if (arg == "-r")
+        runs = atoi(argv[++i]);
+      else if (arg == "-n")
+        name = argv[++i];
+      else if (arg == "-o")
+        output = argv[++i];
+      else if (arg == "-h" || arg == "--help")
+        {
+          print_usage();
+          return 0;
+        }
+      else if (arg[0] == '@')
+        {
+          if (!read_list(arg.substr(1), paths))
+            {
+              std::cerr << "cannot read " << arg.substr(1) << std::endl;
+              return 2;
+            }
+        }
+      else
+        paths.push_back(arg);
+    }
+
+  if (paths.size() < 2 || runs < 1)
+    {
+      print_usage();
+      return 2;
+    }
+
+  if (name.empty())
+    name = paths[0];
+
+  init_core();
+
+  std::vector<std::string> objs(paths.begin() + 1, paths.end());
+  PhaseTimes best;
+
+  for (int r = 0; r < runs; ++r)
+    {
+      PhaseTimes times;
+
+      if (!run_once(paths[0], objs, &times))
+        return 1;
+
+      if (r == 0)
+        best = times;
+
+      best.load = std::min(best.load, times.load);
+      best.bind = std::min(best.bind, times.bind);
+      best.disassemble = std::min(best.disassemble, times.disassemble);
+      best.populate = std::min(best.populate, times.populate);
+    }
+
+  // one line of JSON for every project, so results can be appended
+  std::ostringstream line;
+
+  line << "{\"name\":" << json_string(name)
+       << ",\"objects\":" << objs.size()
+       << ",\"workers\":" << worker_count((size_t) -1)
+       << ",\"runs\":" << runs
+       << ",\"load_ms\":" << best.load
+       << ",\"bind_ms\":" << best.bind
+       << ",\"disassemble_ms\":" << best.disassemble
+       << ",\"populate_ms\":" << best.populate << "}\n";
+
+  if (output.empty())
+    std::cout << line.str();
+  else
+    {
+      std::ofstream out(output, std::ios::app);
+
+      if (!out)
+        {
+          std::cerr << "cannot write " << output << std::endl;
+          return 2;
+        }
+
+      out << line.str();
+    }
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+#ifndef BYTETOOLS_H
+#define BYTETOOLS_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ByteTools
+{
+  // two lowercase hex digits for every byte value, byte b starts at 2 * b
+  extern const char hex_pairs[];
+
+  // writes one "xx " group for a byte
+  inline char *hex_byte(unsigned char b, char *out)
+  {
+    memcpy(out, hex_pairs + 2 * b, 2);
+    out[2] = ' ';
+
+    return out + 3;
+  }
+
+#if defined(__SSE2__)
+  // turns 16 bytes into their 32 hex digits, high nibble first
+  inline void hex_digits_16(const unsigned char *in, char *out)
+  {
+    const __m128i lo_mask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i digit = _mm_set1_epi8('0');
+    const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+
+    __m128i v = _mm_loadu_si128((const __m128i *) in);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), lo_mask);
+    __m128i lo = _mm_and_si128(v, lo_mask);
+
+    // nibbles above 9 are moved into the 'a'..'f' range
+    hi = _mm_add_epi8(_mm_add_epi8(hi, digit),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, digit),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+
+    _mm_storeu_si128((__m128i *) out, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *) (out + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+
+  // encodes *len* bytes as "xx " groups, BPC bytes per chunk, every chunk
+  // being printed most significant byte first when LITTLE is set
+  // *out* must have room for 3 * len chars, returns the end of the output
+  template <int BPC, bool LITTLE>
+  char *hex_encode(const unsigned char *in, size_t len, char *out)
+  {
+    size_t j = 0;
+
+    if (BPC == 1 || !LITTLE)
+      {
+#if defined(__SSE2__)
+        char digits[32];
+
+        for (; j + 16 <= len; j += 16)
+          {
+            hex_digits_16(in + j, digits);
+
+            for (int k = 0; k < 16; ++k)
+              {
+                memcpy(out, digits + 2 * k, 2);
+                out[2] = ' ';
+                out += 3;
+              }
+          }
+#endif
+        for (; j < len; ++j)
+          out = hex_byte(in[j], out);
+
+        return out;
+      }
+
+    for (; j + BPC <= len; j += BPC)
+      for (int k = BPC - 1; k >= 0; --k)
+        out = hex_byte(in[j + k], out);
+
+    // a trailing partial chunk is printed as it is
+    for (; j < len; ++j)
+      out = hex_byte(in[j], out);
+
+    return out;
+  }
+
+  // returns the offset of the first non-zero byte in [from, to), or *to*
+  inline size_t find_nonzero(const unsigned char *data, size_t from, size_t to)
+  {
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+
+    // get to an aligned address so that the vector loads never cross a page
+    while (from < to && ((size_t) (data + from) & 15) != 0)
+      {
+        if (data[from] != 0)
+          return from;
+        ++from;
+      }
+
+    for (; from + 16 <= to; from += 16)
+      {
+        __m128i v = _mm_load_si128((const __m128i *) (data + from));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) ^ 0xffff;
+
+        if (mask != 0)
+          return from + __builtin_ctz(mask);
+      }
+#endif
+    for (; from < to; ++from)
+      if (data[from] != 0)
+        return from;
+
+    return to;
+  }
+
+  // returns the offset of the first byte in [0, len) where *a* and *b*
+  // differ outside of the zero bytes of *mask*, or *len*
+  inline size_t find_masked_mismatch(const unsigned char *a, const unsigned char *b,
+                                     const unsigned char *mask, size_t len)
+  {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= len; i += 16)
+      {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        __m128i vm = _mm_loadu_si128((const __m128i *) (mask + i));
+        __m128i diff = _mm_and_si128(_mm_xor_si128(va, vb), vm);
+        int bits = _mm_movemask_epi8(_mm_cmpeq_epi8(diff, zero)) ^ 0xffff;
+
+        if (bits != 0)
+          return i + __builtin_ctz(bits);
+      }
+#endif
+    for (; i < len; ++i)
+      if ((a[i] ^ b[i]) & mask[i])
+        return i;
+
+    return len;
+  }
+
+  // picks the hex_encode specialization matching the chunk size and
+  // display endianness requested by the disassembler
+  char *hex_encode(const unsigned char *, size_t, int, bool, char *);
+}
+
+#endif // BYTETOOLS_H
@@ -0,0 +1,315 @@
+#include <iostream>
+#include <sstream>
+
+#include "elfdetective.h"
+
+const int FORMAT_TEXT = 0;
+const int FORMAT_JSON = 1;
+
+static void print_usage()
+{
+  std::cerr << "Usage: elfdetective-cli [-j N] [-f json|text] [--sysroot DIR] [-s SECTION]... [-d] [-v]"
+            << " EXE OBJ|ARCHIVE..." << std::endl
+            << "  -j N        worker threads, 0 for one per core" << std::endl
+            << "  -f FORMAT   json (one object per line) or text, the default" << std::endl
+            << "  --sysroot   where the needed libraries are looked up" << std::endl
+            << "  -s SECTION  disassemble only the sections matching these" << std::endl
+            << "              fnmatch patterns, every code section by default" << std::endl
+            << "  -d          print the disassembly of every function" << std::endl
+            << "  -v          report progress on stderr" << std::endl;
+}
+
+static std::string error_text(int errCode)
+{
+  switch (errCode)
+    {
+    case ELF_NOT_EXE:
+    case ELF_NOT_OBJ:
+      return "wrong format";
+    case BFD_FILE_NULL:
+      return "cannot be parsed";
+    case BFD_FILE_SIZE:
+      return "empty";
+    default:
+      return "unknown error";
+    }
+}
+
+// the instruction column of the function trees
+static std::string line_text(const CodeLine *c)
+{
+  if (c->hasRelocs())
+    return c->getLine() + "    ; " + c->getRelocText();
+
+  return c->getLine();
+}
+
+// Prints the results of a run as they come, so a long run can be piped
+// into something else without waiting for the end.
+class CliPrinter : public AnalysisListener
+{
+public:
+  CliPrinter(AnalysisRun *run, int format, bool lines, bool verbose)
+    : run(run), format(format), lines(lines), verbose(verbose)
+  {}
+
+  void progress(std::string phase, std::string file, int done, int total)
+  {
+    if (!this->verbose)
+      return;
+
+    std::cerr << "[" << done << "/" << total << "] " << phase;
+    if (!file.empty())
+      std::cerr << " " << file;
+    std::cerr << std::endl;
+  }
+
+  void bindingReady()
+  {
+    AddressBinding *AB = this->run->getBinding();
+    std::vector<std::string> names = AB->getSymbols();
+
+    std::sort(names.begin(), names.end());
+
+    for (const std::string &S : names)
+      this->printSymbol(AB->getSymbol(S));
+
+    std::cout.flush();
+  }
+
+  void fileDone(ELFFile *E)
+  {
+    for (Function *f : E->getFunctions())
+      this->printFunction(E, f);
+
+    std::cout.flush();
+  }
+
+  void printDiff(const FunctionReport &R)
+  {
+    if (this->format == FORMAT_JSON)
+      std::cout << "{\"type\":\"diff\",\"file\":" << json_string(R.file)
+                << ",\"name\":" << json_string(R.name)
+                << ",\"lines\":" << R.lines
+                << ",\"relocated\":" << R.relocated
+                << ",\"mismatches\":" << R.mismatches
+                << ",\"missing\":" << R.missing << "}\n";
+    else
+      std::cout << "diff " << R.file << " " << R.name << ": " << R.lines
+                << " lines, " << R.relocated << " relocated, " << R.mismatches
+                << " mismatched, " << R.missing << " missing\n";
+  }
+
+  void printError(ELFFile *E, int errCode)
+  {
+    if (this->format == FORMAT_JSON)
+      std::cout << "{\"type\":\"error\",\"file\":" << json_string(E->getName())
+                << ",\"message\":" << json_string(error_text(errCode)) << "}\n";
+    else
+      std::cout << "error " << E->getName() << ": " << error_text(errCode) << "\n";
+  }
+
+  void printOutcome(int outcome)
+  {
+    std::string name = (outcome == ANALYSIS_DONE) ? "done"
+                       : (outcome == ANALYSIS_CANCELLED) ? "cancelled" : "failed";
+
+    if (this->format == FORMAT_JSON)
+      std::cout << "{\"type\":\"outcome\",\"result\":" << json_string(name) << "}\n";
+    else
+      std::cout << name << "\n";
+  }
+
+private:
+  void printSymbol(const Symbol &sym)
+  {
+    std::string kind = sym.isFunction() ? "function" : "variable";
+
+    if (this->format == FORMAT_JSON)
+      {
+        std::cout << "{\"type\":\"symbol\",\"name\":" << json_string(sym.name)
+                  << ",\"kind\":" << json_string(kind)
+                  << ",\"defined\":" << (sym.isUndefined() ? "false" : "true")
+                  << ",\"defined_in\":" << json_string(sym.defined_in)
+                  << ",\"exe_value\":" << json_string(sym.exe_value)
+                  << ",\"section\":" << json_string(sym.section_name)
+                  << ",\"provided_by\":" << json_string(sym.provided_by)
+                  << ",\"undefined_in\":[";
+
+        for (size_t i = 0; i < sym.undefined_in.size(); ++i)
+          std::cout << (i ? "," : "") << json_string(sym.undefined_in[i]);
+
+        std::cout << "]}\n";
+        return;
+      }
+
+    std::cout << "symbol " << kind << " " << sym.name;
+
+    if (sym.isUndefined())
+      std::cout << " undefined"
+                << (sym.provided_by.empty() ? "" : ", provided by " + sym.provided_by);
+    else
+      std::cout << " in " << sym.defined_in << " at " << sym.exe_value
+                << " (" << sym.section_name << ")";
+
+    std::cout << "\n";
+  }
+
+  void printFunction(ELFFile *E, Function *f)
+  {
+    if (this->format == FORMAT_JSON)
+      {
+        std::cout << "{\"type\":\"function\",\"file\":" << json_string(E->getName())
+                  << ",\"name\":" << json_string(f->getName())
+                  << ",\"instructions\":" << f->getCodeLineCount();
+
+        if (this->lines)
+          {
+            std::cout << ",\"lines\":[";
+
+            for (size_t i = 0; i < f->getCodeLineCount(); ++i)
+              {
+                const CodeLine *c = f->getCodeLine(i);
+
+                std::cout << (i ? "," : "") << "{\"address\":" << json_string(c->getAddress())
+                          << ",\"instruction\":" << json_string(line_text(c))
+                          << ",\"opcode\":" << json_string(c->getHexValue()) << "}";
+              }
+
+            std::cout << "]";
+          }
+
+        std::cout << "}\n";
+        return;
+      }
+
+    std::cout << "function " << E->getName() << " " << f->getName()
+              << ": " << f->getCodeLineCount() << " instructions\n";
+
+    if (!this->lines)
+      return;
+
+    for (size_t i = 0; i < f->getCodeLineCount(); ++i)
+      {
+        const CodeLine *c = f->getCodeLine(i);
+
+        std::cout << "  " << c->getAddress() << "  " << c->getHexValue()
+                  << "  " << line_text(c) << "\n";
+      }
+  }
+
+  AnalysisRun *run;
+  int format;
+  bool lines;
+  bool verbose;
+};
+
+int main(int argc, char *argv[])
+{
+  int format = FORMAT_TEXT;
+  bool lines = false;
+  bool verbose = false;
+  std::string sysroot;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if ((arg == "-j" || arg == "-f" || arg == "--sysroot" || arg == "-s") && i + 1 == argc)
+        {
+          print_usage();
+          return 2;
+        }
+
+      if (arg == "-j")
+        {
+          std::istringstream iss(argv[++i]);
+          size_t jobs;
+
+          if (!(iss >> jobs))
+            {
+              print_usage();
+              return 2;
+            }
+
+          set_worker_count(jobs);
+        }
+      else if (arg == "-f")
+        {
+          std::string name = argv[++i];
+
+          if (name == "json")
+            format = FORMAT_JSON;
+          else if (name == "text")
+            format = FORMAT_TEXT;
+          else
+            {
+              print_usage();
+              return 2;
+            }
+        }
+      else if (arg == "--sysroot")
+        sysroot = argv[++i];
+      else if (arg == "-s")
+        Disassembly::add_section(argv[++i]);
+      else if (arg == "-d")
+        lines = true;
+      else if (arg == "-v")
+        verbose = true;
+      else if (arg == "-h" || arg == "--help")
+        {
+          print_usage();
+          return 0;
+        }
+      else
+        paths.push_back(arg);
+    }
+
+  if (paths.size() < 2)
+    {
+      print_usage();
+      return 2;
+    }
+
+  init_core();
+
+  ELFFile *exefile = new ELFFile(paths[0]);
+  std::vector<ELFFile *> objfiles;
+
+  // an archive brings in every one of its members
+  for (size_t i = 1; i < paths.size(); ++i)
+    {
+      std::vector<std::string> members = ELFFile::archiveMembers(paths[i]);
+
+      if (members.empty())
+        objfiles.push_back(new ELFFile(paths[i]));
+
+      for (size_t m = 0; m < members.size(); ++m)
+        objfiles.push_back(new ELFFile(paths[i], members[m], m));
+    }
+
+  AnalysisRun run(exefile, objfiles, sysroot);
+  CliPrinter printer(&run, format, lines, verbose);
+
+  int outcome = run.run(&printer);
+
+  for (auto &E : run.getErrors())
+    printer.printError(E.first, E.second);
+
+  if (run.getDiff())
+    for (const FunctionReport &R : run.getDiff()->compareAll())
+      printer.printDiff(R);
+
+  printer.printOutcome(outcome);
+  std::cout.flush();
+
+  delete run.getDiff();
+  delete run.getBinding();
+
+  for (ELFFile *E : objfiles)
+    delete E;
+  delete exefile;
+
+  return (outcome == ANALYSIS_DONE) ? 0 : 1;
+}
@@ -1,10 +1,12 @@
 #include "codeline.h"
 
-#include <regex>
 #include <sstream>
 #include <cstring>
+#include <cstdio>
 
-CodeLine::CodeLine() : line(""), address(""), hexValue(""), symbol("")
+CodeLine::CodeLine()
+  : line(""), address(""), hexValue(""), symbol(""), vma(0), length(0),
+    target(0), targetSet(false), ripRelative(false), displacement(0)
 {}
 
 CodeLine::~CodeLine()
@@ -63,38 +65,140 @@ std::string CodeLine::getSymbol() const
   return this->symbol;
 }
 
-void CodeLine::additionalInformation(std::string addr)
+void CodeLine::setVma(bfd_vma vma)
 {
-  char str[256];
-  char *token;
-  std::string tok;
-  std::string referredAddr;
-  std::size_t pos;
+  this->vma = vma;
+}
+
+void CodeLine::setLength(int length)
+{
+  this->length = length;
+}
+
+void CodeLine::setTarget(bfd_vma target)
+{
+  this->target = target;
+  this->targetSet = true;
+}
+
+void CodeLine::setRipRelative(bfd_signed_vma disp)
+{
+  this->ripRelative = true;
+  this->displacement = disp;
+}
+
+bfd_vma CodeLine::getVma() const
+{
+  return this->vma;
+}
+
+int CodeLine::getLength() const
+{
+  return this->length;
+}
+
+bfd_vma CodeLine::getTarget() const
+{
+  return this->target;
+}
+
+bool CodeLine::hasTarget() const
+{
+  return this->targetSet;
+}
+
+bool CodeLine::isRipRelative() const
+{
+  return this->ripRelative;
+}
+
+void CodeLine::addReloc(const char *type, const char *symbol,
+                        bfd_signed_vma addend, bfd_vma address)
+{
+  LineReloc R;
 
-  this->line.copy(str, this->line.length(), 0);
-  token = strtok((char*)str, " ,");
-  while (token != NULL)
+  R.type = type;
+  R.symbol = symbol;
+  R.addend = addend;
+  R.address = address;
+
+  this->relocs.push_back(R);
+}
+
+bool CodeLine::hasRelocs() const
+{
+  return !this->relocs.empty();
+}
+
+std::string CodeLine::getRelocText() const
+{
+  std::string ret;
+  char addend[32];
+
+  for (const LineReloc &R : this->relocs)
     {
-      tok = token;
-      pos = tok.find("(%rip)");
-      if (pos != std::string::npos)
+      if (!ret.empty())
+        ret += ", ";
+
+      ret += (R.type != NULL) ? R.type : "?";
+      ret += " ";
+      ret += (R.symbol != NULL) ? R.symbol : "*unknown*";
+
+      if (R.addend)
         {
-          referredAddr = tok.substr(0, pos);
-          break;
+          snprintf(addend, sizeof(addend), "%s0x%llx", R.addend < 0 ? "-" : "+",
+                   (unsigned long long) (R.addend < 0 ? -R.addend : R.addend));
+          ret += addend;
         }
-
-      token = strtok(NULL, " ,");
     }
 
-  this->moreInfo = "%rip points to the next instruction =" + addr + "\n";
-  this->moreInfo += "Symbol address is found by: " + addr + " + " + referredAddr + "\n";
+  return ret;
 }
 
 std::string CodeLine::dumpData() const
 {
+  std::string ret;
+
+  if (!this->relocs.empty())
+    {
+      char at[32];
+
+      for (const LineReloc &R : this->relocs)
+        {
+          snprintf(at, sizeof(at), "0x%llx", (unsigned long long) R.address);
+
+          ret += "Relocation at " + std::string(at) + ": " + ((R.type != NULL) ? R.type : "?")
+              + " against " + ((R.symbol != NULL) ? R.symbol : "*unknown*");
+
+          if (R.addend)
+            {
+              snprintf(at, sizeof(at), " %s 0x%llx", R.addend < 0 ? "-" : "+",
+                       (unsigned long long) (R.addend < 0 ? -R.addend : R.addend));
+              ret += at;
+            }
+
+          ret += "\n";
+        }
+    }
+
   if (this->symbol.compare("") == 0)
-    return "";
+    return ret;
+
+  ret += "This line references symbol: <" + this->symbol + ">(" + this->symbolAddress + ")\n";
+
+  if (this->ripRelative)
+    {
+      char next[32];
+      char disp[32];
+      bfd_signed_vma d = this->displacement;
+
+      snprintf(next, sizeof(next), "0x%llx", (unsigned long long) (this->vma + this->length));
+      snprintf(disp, sizeof(disp), "%s0x%llx", d < 0 ? "-" : "",
+               (unsigned long long) (d < 0 ? -d : d));
+
+      ret += "%rip points to the next instruction = " + std::string(next) + "\n";
+      ret += "Symbol address is found by: " + std::string(next) + " + " + disp + "\n";
+    }
 
-  return "This line references symbol: <" + this->symbol + ">(" + this->symbolAddress + ")\n" +
-      (this->moreInfo == "" ? "" : this->moreInfo);
+  return ret;
 }
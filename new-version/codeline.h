@@ -2,6 +2,13 @@
 #define CODELINE_H
 
 #include <string>
+#include <vector>
+
+// this needs to be defined before any bfd.h include
+// due to a 'won't fix' bug
+#define PACKAGE "elfdetective"
+
+#include <bfd.h>
 
 class CodeLine
 {
@@ -14,12 +21,30 @@ public:
   void setHexValue(std::string);
   void setSymbol(std::string, std::string);
 
+  void setVma(bfd_vma);
+  void setLength(int);
+  void setTarget(bfd_vma);
+  void setRipRelative(bfd_signed_vma);
+
+  // a relocation applied inside the instruction; the names are kept as
+  // pointers into the relocation tables and bfd, which outlive the line
+  void addReloc(const char *, const char *, bfd_signed_vma, bfd_vma);
+
   std::string getLine() const;
   std::string getAddress() const;
   std::string getHexValue() const;
   std::string getSymbol() const;
 
-  void additionalInformation(std::string);
+  bfd_vma getVma() const;
+  int getLength() const;
+  bfd_vma getTarget() const;
+  bool hasTarget() const;
+  bool isRipRelative() const;
+  bool hasRelocs() const;
+
+  // "R_X86_64_PLT32 puts-0x4" for every relocation of the line
+  std::string getRelocText() const;
+
   std::string dumpData() const;
 
 protected:
@@ -29,6 +54,23 @@ private:
   std::string hexValue;
   std::string symbol;
   std::string symbolAddress;
-  std::string moreInfo;
+
+  // numeric view of the instruction, filled during disassembly
+  bfd_vma vma;
+  int length;
+  bfd_vma target;
+  bool targetSet;
+  bool ripRelative;
+  bfd_signed_vma displacement;
+
+  struct LineReloc
+  {
+    const char *type;
+    const char *symbol;
+    bfd_signed_vma addend;
+    bfd_vma address;
+  };
+
+  std::vector<LineReloc> relocs;
 };
 #endif // CODELINE_H
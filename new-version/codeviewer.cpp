@@ -0,0 +1,132 @@
+#include <QFontDatabase>
+#include <cstdlib>
+
+#include "codeviewer.h"
+#include "ui_codeviewer.h"
+#include "disassemblemodule.h"
+
+CodeViewer::CodeViewer(QWidget *parent) :
+  QWidget(parent, Qt::Window),
+  ui(new Ui::CodeViewer)
+{
+  ui->setupUi(this);
+
+  this->model = new FunctionTreeModel(this);
+
+  ui->codeTree->setModel(this->model);
+  ui->codeTree->setUniformRowHeights(true);
+  ui->codeTree->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  connect(ui->gotoEdit, SIGNAL(returnPressed()), this, SLOT(goTo()));
+}
+
+CodeViewer::~CodeViewer()
+{
+  this->clear();
+
+  delete this->file;
+  delete ui;
+}
+
+bool CodeViewer::open(QString path)
+{
+  this->clear();
+
+  delete this->file;
+  this->file = new ELFFile(path.toStdString());
+
+  this->setWindowTitle(path);
+
+  if (this->file->initBfd(ELF_EXE_FILE) != 0 || !this->symbols.open(path.toStdString()))
+    {
+      delete this->file;
+      this->file = nullptr;
+      return false;
+    }
+
+  return true;
+}
+
+void CodeViewer::clear()
+{
+  // the rows point into the functions
+  this->model->clear();
+
+  for (Function *f : this->shown)
+    delete f;
+
+  this->shown.clear();
+}
+
+// a symbol, or a hex address
+void CodeViewer::goTo()
+{
+  std::string text = ui->gotoEdit->text().trimmed().toStdString();
+  size_t section;
+  uint64_t offset;
+
+  if (text.empty() || this->file == nullptr)
+    return;
+
+  if (this->symbols.findSymbol(text, &section, &offset))
+    {
+      this->showAt(this->symbols.getSections()[section].vma + offset);
+      return;
+    }
+
+  char *end;
+  bfd_vma value = strtoull(text.c_str(), &end, 16);
+
+  if (*end == '\0')
+    this->showAt(value);
+}
+
+// disassembles the window around *vma* and selects its line
+void CodeViewer::showAt(bfd_vma vma)
+{
+  if (this->file == nullptr)
+    return;
+
+  this->clear();
+
+  bfd_vma start = (vma > CODE_WINDOW / 2) ? vma - CODE_WINDOW / 2 : 0;
+
+  this->shown = Disassembly::disassemble_range(this->file, start, start + CODE_WINDOW);
+
+  // the window may begin before the code section does
+  if (this->shown.empty())
+    this->shown = Disassembly::disassemble_range(this->file, vma, vma + CODE_WINDOW / 2);
+
+  std::vector<FunctionTreeModel::Entry> entries;
+
+  for (Function *f : this->shown)
+    entries.push_back(FunctionTreeModel::Entry{f->getName(), f, ""});
+
+  this->model->setEntries(entries);
+
+  ui->codeTree->setColumnWidth(0, 150);
+
+  // the line holding the address, in the last function starting before it
+  for (int row = (int) this->shown.size() - 1; row >= 0; --row)
+    {
+      Function *f = this->shown[row];
+
+      if (f->getCodeLineCount() == 0 || f->getCodeLine(0)->getVma() > vma)
+        continue;
+
+      size_t line = 0;
+
+      while (line + 1 < f->getCodeLineCount() && f->getCodeLine(line + 1)->getVma() <= vma)
+        ++line;
+
+      QModelIndex parent = this->model->index(row, 0);
+      QModelIndex index = this->model->index((int) line, 0, parent);
+
+      ui->codeTree->expand(parent);
+      ui->codeTree->setCurrentIndex(index);
+      ui->codeTree->scrollTo(index, QAbstractItemView::PositionAtCenter);
+      break;
+    }
+
+  ui->gotoEdit->setText(QString::number((qulonglong) vma, 16));
+}
@@ -0,0 +1,53 @@
+#ifndef CODEVIEWER_H
+#define CODEVIEWER_H
+
+#include <QWidget>
+#include <QString>
+#include <vector>
+
+#include "elffile.h"
+#include "sectionmap.h"
+#include "functiontreemodel.h"
+
+// bytes disassembled around the address asked for
+const bfd_vma CODE_WINDOW = 4096;
+
+namespace Ui {
+  class CodeViewer;
+}
+
+// A window showing the code around any address of a file. It opens the
+// file on its own and only disassembles a window of it, through
+// Disassembly::disassemble_range, so going into the middle of a huge
+// function doesn't wait for the whole file or for a run.
+class CodeViewer : public QWidget
+{
+  Q_OBJECT
+
+public:
+  explicit CodeViewer(QWidget *parent = 0);
+  ~CodeViewer();
+
+  // false when the file can't be loaded
+  bool open(QString);
+
+  void showAt(bfd_vma);
+
+private slots:
+  void goTo();
+
+private:
+  void clear();
+
+  Ui::CodeViewer *ui;
+
+  ELFFile *file = nullptr;
+  // the symbols, looked up without bfd
+  SectionMap symbols;
+
+  FunctionTreeModel *model;
+  // the functions of the window, owned here
+  std::vector<Function *> shown;
+};
+
+#endif // CODEVIEWER_H
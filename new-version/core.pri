@@ -0,0 +1,123 @@
+# the sources of the analysis core, built into a library by
+# elfdetective-core.pro
+
+QMAKE_CXXFLAGS += -std=c++11
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/addressbinding.cpp \
+    $$PWD/elffile.cpp \
+    $$PWD/tools.cpp \
+    $$PWD/symbol.cpp \
+    $$PWD/disassemblemodule.cpp \
+    $$PWD/function.cpp \
+    $$PWD/codeline.cpp \
+    $$PWD/bytetools.cpp \
+    $$PWD/insndecoder.cpp \
+    $$PWD/functiondiff.cpp \
+    $$PWD/linkverifier.cpp \
+    $$PWD/reloctable.cpp \
+    $$PWD/relocnames.cpp \
+    $$PWD/sharedlibs.cpp \
+    $$PWD/objectdiscovery.cpp \
+    $$PWD/linkermap.cpp \
+    $$PWD/functionchannel.cpp \
+    $$PWD/sectionmap.cpp \
+    $$PWD/layoutindex.cpp \
+    $$PWD/analysisrun.cpp
+
+HEADERS += $$PWD/addressbinding.h \
+    $$PWD/elffile.h \
+    $$PWD/tools.h \
+    $$PWD/symbol.h \
+    $$PWD/disassemblemodule.h \
+    $$PWD/function.h \
+    $$PWD/codeline.h \
+    $$PWD/bytetools.h \
+    $$PWD/insndecoder.h \
+    $$PWD/functiondiff.h \
+    $$PWD/linkverifier.h \
+    $$PWD/reloctable.h \
+    $$PWD/relocnames.h \
+    $$PWD/sharedlibs.h \
+    $$PWD/objectdiscovery.h \
+    $$PWD/linkermap.h \
+    $$PWD/functionchannel.h \
+    $$PWD/sectionmap.h \
+    $$PWD/layoutindex.h \
+    $$PWD/elfbytes.h \
+    $$PWD/elf-bfd.h \
+    $$PWD/elf/aarch64.h \
+    $$PWD/elf/alpha.h \
+    $$PWD/elf/arc.h \
+    $$PWD/elf/arm.h \
+    $$PWD/elf/avr.h \
+    $$PWD/elf/bfin.h \
+    $$PWD/elf/common.h \
+    $$PWD/elf/cr16.h \
+    $$PWD/elf/cr16c.h \
+    $$PWD/elf/cris.h \
+    $$PWD/elf/crx.h \
+    $$PWD/elf/d10v.h \
+    $$PWD/elf/d30v.h \
+    $$PWD/elf/dlx.h \
+    $$PWD/elf/dwarf.h \
+    $$PWD/elf/epiphany.h \
+    $$PWD/elf/external.h \
+    $$PWD/elf/fr30.h \
+    $$PWD/elf/frv.h \
+    $$PWD/elf/ft32.h \
+    $$PWD/elf/h8.h \
+    $$PWD/elf/hppa.h \
+    $$PWD/elf/i370.h \
+    $$PWD/elf/i386.h \
+    $$PWD/elf/i860.h \
+    $$PWD/elf/i960.h \
+    $$PWD/elf/ia64.h \
+    $$PWD/elf/internal.h \
+    $$PWD/elf/ip2k.h \
+    $$PWD/elf/iq2000.h \
+    $$PWD/elf/lm32.h \
+    $$PWD/elf/m32c.h \
+    $$PWD/elf/m32r.h \
+    $$PWD/elf/m68hc11.h \
+    $$PWD/elf/m68k.h \
+    $$PWD/elf/mcore.h \
+    $$PWD/elf/mep.h \
+    $$PWD/elf/metag.h \
+    $$PWD/elf/microblaze.h \
+    $$PWD/elf/mips.h \
+    $$PWD/elf/mmix.h \
+    $$PWD/elf/mn10200.h \
+    $$PWD/elf/mn10300.h \
+    $$PWD/elf/moxie.h \
+    $$PWD/elf/msp430.h \
+    $$PWD/elf/mt.h \
+    $$PWD/elf/nds32.h \
+    $$PWD/elf/nios2.h \
+    $$PWD/elf/or1k.h \
+    $$PWD/elf/pj.h \
+    $$PWD/elf/ppc.h \
+    $$PWD/elf/ppc64.h \
+    $$PWD/elf/reloc-macros.h \
+    $$PWD/elf/riscv.h \
+    $$PWD/elf/rl78.h \
+    $$PWD/elf/rx.h \
+    $$PWD/elf/s390.h \
+    $$PWD/elf/score.h \
+    $$PWD/elf/sh.h \
+    $$PWD/elf/sparc.h \
+    $$PWD/elf/spu.h \
+    $$PWD/elf/tic6x-attrs.h \
+    $$PWD/elf/tic6x.h \
+    $$PWD/elf/tilegx.h \
+    $$PWD/elf/tilepro.h \
+    $$PWD/elf/v850.h \
+    $$PWD/elf/vax.h \
+    $$PWD/elf/visium.h \
+    $$PWD/elf/vxworks.h \
+    $$PWD/elf/x86-64.h \
+    $$PWD/elf/xc16x.h \
+    $$PWD/elf/xgate.h \
+    $$PWD/elf/xstormy16.h \
+    $$PWD/elf/xtensa.h
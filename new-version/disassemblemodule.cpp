@@ -2,54 +2,56 @@
 
 #include <algorithm>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <fnmatch.h>
 
 #include "function.h"
 #include "codeline.h"
+#include "bytetools.h"
+#include "insndecoder.h"
+#include "relocnames.h"
 
 namespace Disassembly
 {
   static const int DEFAULT_SKIP_ZEROES = 8;
   static const int DEFAULT_SKIP_ZEROES_AT_END = 3;
 
+  // section filter, empty means every code section; read while a file
+  // is disassembled, so it only changes under bfd_lock
   static std::vector<std::string> sections;
-  static std::string disassemble_line;
 
-  static ELFFile *crtFile = nullptr;
-  static CodeLine *crtLine = nullptr;
+  // a window that starts further than this from its function is resynced
+  // with the boundary decoder instead of disassembling from the symbol
+  static const bfd_vma RESYNC_DISTANCE = 4096;
+  static const bfd_vma RESYNC_BACKOFF = 256;
 
-  static bfd_vma start_address;
-  static bfd_vma stop_address;
+  // longest instruction of the supported targets, a window is read this
+  // much past its end so the last instruction is complete
+  static const bfd_vma MAX_INSN_OCTETS = 16;
 
-  // symbol tables
-  static asymbol **syms = NULL;
-  static asymbol **dynsyms = NULL;
-  static asymbol **sorted_syms = NULL;
-  static asymbol *synthsyms = NULL;
+  // Endianness to disassemble for, unknown keeps the file's own
+  static const enum bfd_endian endian = BFD_ENDIAN_UNKNOWN;
 
-  // symbol counts
-  static long symcount;
-  static long dynsymcount;
-  static long sorted_symcount;
-  static long synthcount;
+  // most libopcodes disassemblers keep their state in globals
+#ifndef ELFDETECTIVE_REENTRANT_OPCODES
+  static std::mutex opcodes_lock;
+#endif
 
-  // Endianness to disassemble for
-  static enum bfd_endian endian;
-
-  void print_to_string(std::string str)
+  void print_to_string(struct disassemble_info *inf, std::string str)
   {
-    disassemble_line += str;
+    ((struct disasm_info *) inf->application_data)->text += str;
   }
 
-  // called by disassembler, writes code to *disassemble_line*
-  int ATTRIBUTE_PRINTF_2 disassemble_print (SFILE *f, const char *format, ...)
+  // called by disassembler, writes code to the worker's *text*
+  int ATTRIBUTE_PRINTF_2 disassemble_print (void *stream, const char *format, ...)
   {
     int final_n, n;
     std::string str;
     std::unique_ptr<char[]> formatted;
     va_list ap;
 
-    (void)f;
-
     n = strlen(format) * 2;
 
     while(1)
@@ -67,7 +69,7 @@ namespace Disassembly
           break;
       }
 
-    disassemble_line += std::string(formatted.get());
+    ((struct disasm_info *) stream)->text += formatted.get();
 
     return final_n;
   }
@@ -75,28 +77,30 @@ namespace Disassembly
   // returns true if section is to be processed
   bfd_boolean process_section_p (asection *section)
   {
-    std::string section_name = section->name;
+    if ((section->flags & SEC_CODE) == 0
+        || (section->flags & SEC_HAS_CONTENTS) == 0)
+      return FALSE;
+
+    if (sections.empty())
+      return TRUE;
+
+    for (const std::string &pattern : sections)
+      if (fnmatch(pattern.c_str(), section->name, 0) == 0)
+        return TRUE;
 
-    return std::find(sections.begin(), sections.end(), section_name) != sections.end();
+    return FALSE;
   }
 
-  // used by qsort to sort symbols by address
-  int compare_relocs (const void *ap, const void *bp)
+  // resolves the filter once per file, indexed by section->index
+  std::vector<bool> select_sections (bfd *abfd)
   {
-    const arelent *a = * (const arelent **) ap;
-    const arelent *b = * (const arelent **) bp;
-
-    if (a->address > b->address)
-      return 1;
-    else if (a->address < b->address)
-      return -1;
-
-    if (a > b)
-      return 1;
-    else if (a < b)
-      return -1;
-    else
-      return 0;
+    std::vector<bool> selected(bfd_count_sections(abfd), false);
+
+    for (asection *section = abfd->sections; section != NULL; section = section->next)
+      if (section->index < selected.size())
+        selected[section->index] = process_section_p(section);
+
+    return selected;
   }
 
   // finds where the referenced address points to
@@ -106,14 +110,21 @@ namespace Disassembly
     (void)abfd;
     (void)sec;
 
-    if (sym && crtLine)
+    if (sym && ((struct disasm_info *) inf->application_data)->line)
       {
-        char buf[30];
-        struct disasm_info *aux;
-
         print_value(vma, inf);
+        label_line(sym, vma, inf);
+      }
+  }
+
+  // stores the symbol referenced by the current code line
+  void label_line (asymbol *sym, bfd_vma vma, struct disassemble_info *inf)
+  {
+    struct disasm_info *aux = (struct disasm_info *) inf->application_data;
 
-        aux = (struct disasm_info *) inf->application_data;
+    if (sym && aux->line)
+      {
+        char buf[30];
 
         std::string value = bfd_asymbol_name(sym);
 
@@ -137,19 +148,52 @@ namespace Disassembly
             value += format;
           }
 
-        crtLine->setSymbol(value, symAddr);
+        aux->line->setSymbol(value, symAddr);
       }
   }
 
+  // names a GOT slot after the symbol its dynamic relocation binds
+  void label_got_slot (bfd_vma vma, struct disassemble_info *inf)
+  {
+    struct disasm_info *aux = (struct disasm_info *) inf->application_data;
+
+    if (aux->dynrelocs == NULL || aux->line == NULL)
+      return;
+
+    arelent *r = aux->dynrelocs->findDynamic(vma);
+
+    if (r == NULL || r->sym_ptr_ptr == NULL || *r->sym_ptr_ptr == NULL)
+      return;
+
+    const char *name = bfd_asymbol_name(*r->sym_ptr_ptr);
+
+    if (name == NULL || *name == '\0')
+      return;
+
+    char buf[30];
+
+    bfd_sprintf_vma(aux->abfd, buf, vma);
+    aux->line->setSymbol(std::string(name) + "@got", buf);
+  }
+
+  // true for the sections holding PLT stubs
+  bool is_plt_section (asection *section)
+  {
+    return strncmp(section->name, ".plt", 4) == 0
+        || strncmp(section->name, ".iplt", 5) == 0;
+  }
+
   // finds the symbol of the requested address
   asymbol *find_symbol_for_address (bfd_vma vma,
                                     struct disassemble_info *inf,
                                     long *place)
   {
+    struct disasm_info *aux = (struct disasm_info *) inf->application_data;
+    asymbol **sorted_syms = aux->sorted_syms;
+    long sorted_symcount = aux->sorted_symcount;
     long min = 0;
     long max_count = sorted_symcount;
     long thisplace;
-    struct disasm_info *aux;
     bfd *abfd;
     asection *sec;
     unsigned int opb;
@@ -158,7 +202,6 @@ namespace Disassembly
     if (sorted_symcount < 1)
       return NULL;
 
-    aux = (struct disasm_info *)inf->application_data;
     abfd = aux->abfd;
     sec = aux->sec;
     opb = inf->octets_per_byte;
@@ -288,7 +331,7 @@ namespace Disassembly
         strBuf = buf;
       }
 
-    print_to_string(strBuf);
+    print_to_string(inf, strBuf);
   }
 
 
@@ -302,7 +345,7 @@ namespace Disassembly
 
     aux = (struct disasm_info *)inf->application_data;
 
-    if (sorted_symcount < 1)
+    if (aux->sorted_symcount < 1)
       return;
 
     if (aux->reloc != NULL
@@ -369,10 +412,9 @@ namespace Disassembly
                           bfd_byte *                data,
                           bfd_vma                   start_offset,
                           bfd_vma                   stop_offset,
-                          bfd_vma		     rel_offset,
-                          arelent ***               relppp,
-                          arelent **                relppend,
-                          Function *f)
+                          RelocTable::Cursor *      relocs,
+                          Function *f,
+                          const std::vector<InsnDecoder::Insn> *decoded)
   {
     struct disasm_info *aux;
     asection *section;
@@ -381,17 +423,10 @@ namespace Disassembly
     bfd_vma addr_offset;
     unsigned int opb = inf->octets_per_byte;
     int octets = opb;
-    SFILE sfile;
-
-    char hexdump[2];
 
     aux = (struct disasm_info *) inf->application_data;
     section = aux->sec;
 
-    sfile.alloc = 120;
-    sfile.buffer = (char *) malloc(sfile.alloc);
-    sfile.pos = 0;
-
     if (insns)
       octets_per_line = 4;
     else
@@ -416,14 +451,25 @@ namespace Disassembly
 
     inf->insn_info_valid = 0;
 
+    // *data* may only hold a window of the section, starting at *base*
+    bfd_vma base = (inf->buffer_vma - section->vma) * opb;
+
+    // first non-zero octet at or after the current address, it only needs
+    // to be looked up again once the address moves past it
+    bfd_vma z = ByteTools::find_nonzero(data, start_offset * opb - base,
+                                        stop_offset * opb - base) + base;
+
+    // the boundary pass result, walked in step with the instructions
+    size_t next_decoded = 0;
+
     addr_offset = start_offset;
     while (addr_offset < stop_offset)
       {
-        bfd_vma z;
         int previous_octets;
 
         // new codeline in current function
-        crtLine = new CodeLine();
+        CodeLine *crtLine = new CodeLine();
+        aux->line = crtLine;
         std::string hexString;
 
         // Remember the length of the previous instruction.
@@ -433,13 +479,12 @@ namespace Disassembly
         // Make sure we don't use relocs from previous instructions.
         aux->reloc = NULL;
 
-        for (z = addr_offset * opb; z < stop_offset * opb; z++)
-          if (data[z] != 0)
-            break;
+        if (z < addr_offset * opb)
+          z = ByteTools::find_nonzero(data, addr_offset * opb - base,
+                                      stop_offset * opb - base) + base;
 
         char buf[50];
         int bpc = 0;
-        int pb = 0;
 
         char *s;
 
@@ -451,11 +496,46 @@ namespace Disassembly
 
         crtLine->setAddress(buf + skip_addr_chars);
 
-        if (insns)
+        bfd_vma zeroes = z - addr_offset * opb;
+
+        // zeroes carrying a relocation are real data, stop the run there
+        if (zeroes && !relocs->atEnd()
+            && relocs->current()->address < addr_offset + zeroes / opb)
+          {
+            zeroes = 0;
+            if (relocs->current()->address > addr_offset)
+              zeroes = (relocs->current()->address - addr_offset) * opb;
+          }
+
+        // collapse long runs of zeroes into a single "..." line, the same
+        // way objdump does
+        if ((inf->insn_info_valid == 0 || inf->branch_delay_insns == 0)
+            && (zeroes >= (bfd_vma) inf->skip_zeroes
+                || (addr_offset * opb + zeroes == stop_offset * opb
+                    && zeroes < (bfd_vma) inf->skip_zeroes_at_end)))
           {
-            sfile.pos = 0;
+            // if more instructions follow, only skip multiples of 4 so the
+            // start of an instruction beginning with a zero is not eaten
+            if (addr_offset * opb + zeroes != stop_offset * opb)
+              zeroes &= ~(bfd_vma) 3;
 
-            inf->stream = &sfile;
+            if (zeroes != 0)
+              {
+                octets = (int) zeroes;
+
+                crtLine->setVma(section->vma + addr_offset);
+                crtLine->setLength(octets / opb);
+                crtLine->setLine("...");
+                f->addCodeLine(crtLine);
+
+                addr_offset += octets / opb;
+                continue;
+              }
+          }
+
+        if (insns)
+          {
+            inf->stream = aux;
             inf->bytes_per_line = 0;
             inf->bytes_per_chunk = 0;
             inf->flags = DISASSEMBLE_DATA;
@@ -463,12 +543,11 @@ namespace Disassembly
             if (inf->disassembler_needs_relocs
                 && (bfd_get_file_flags(aux->abfd) & EXEC_P) == 0
                 && (bfd_get_file_flags(aux->abfd) & DYNAMIC) == 0
-                && *relppp < relppend)
+                && !relocs->atEnd())
               {
                 bfd_signed_vma distance_to_rel;
 
-                distance_to_rel = (**relppp)->address
-                    - (rel_offset + addr_offset);
+                distance_to_rel = relocs->current()->address - addr_offset;
 
                 // Check to see if the current reloc is associated with
                 // the instruction that we are about to disassemble.
@@ -476,16 +555,61 @@ namespace Disassembly
                                              && distance_to_rel < (bfd_signed_vma) (previous_octets/ opb)))
                   {
                     inf->flags |= INSN_HAS_RELOC;
-                    aux->reloc = **relppp;
+                    aux->reloc = relocs->current();
                   }
               }
 
-            octets = (*disassemble_fn) (section->vma + addr_offset, inf);
+            {
+#ifndef ELFDETECTIVE_REENTRANT_OPCODES
+              std::lock_guard<std::mutex> lock(opcodes_lock);
+#endif
+              octets = (*disassemble_fn) (section->vma + addr_offset, inf);
+            }
 
             if (inf->bytes_per_line != 0)
               octets_per_line = inf->bytes_per_line;
             if (octets < (int) opb)
-              break;
+              {
+                delete crtLine;
+                aux->line = NULL;
+                aux->text.clear();
+                break;
+              }
+
+            // operand targets come from the encoding, not from the text
+            const InsnDecoder::Insn *insn = NULL;
+            bfd_vma vma = section->vma + addr_offset;
+
+            if (decoded != NULL)
+              {
+                while (next_decoded < decoded->size() && (*decoded)[next_decoded].vma < vma)
+                  ++next_decoded;
+
+                if (next_decoded < decoded->size() && (*decoded)[next_decoded].vma == vma
+                    && (*decoded)[next_decoded].length == octets)
+                  insn = &(*decoded)[next_decoded];
+              }
+
+            if (insn != NULL)
+              {
+                if (insn->flags & INSN_RIPREL)
+                  crtLine->setRipRelative(insn->disp);
+
+                if ((insn->flags & INSN_RIPREL) || insn->kind == INSN_JUMP
+                    || insn->kind == INSN_COND_JUMP || insn->kind == INSN_CALL)
+                  crtLine->setTarget(insn->target);
+              }
+            else if (inf->insn_info_valid && inf->target != 0)
+              crtLine->setTarget(inf->target);
+
+            // the disassembler doesn't print every target it knows about
+            if (crtLine->hasTarget() && crtLine->getSymbol().empty())
+              label_line(find_symbol_for_address(crtLine->getTarget(), inf, NULL),
+                         crtLine->getTarget(), inf);
+
+            // a GOT slot is better known by what it will hold
+            if (crtLine->hasTarget())
+              label_got_slot(crtLine->getTarget(), inf);
           }
         else
           {
@@ -497,107 +621,45 @@ namespace Disassembly
 
             for (j = addr_offset * opb; j < addr_offset * opb + octets; ++j)
               {
-                if (ISPRINT(data[j]))
-                  buf[j - addr_offset * opb] = data[j];
+                if (ISPRINT(data[j - base]))
+                  buf[j - addr_offset * opb] = data[j - base];
                 else
                   buf[j - addr_offset * opb] = '.';
               }
             buf[j - addr_offset * opb] = '\0';
           }
-        bfd_vma j;
-
-        pb = octets;
 
         if (inf->bytes_per_chunk)
           bpc = inf->bytes_per_chunk;
         else
           bpc = 1;
 
-        for (j = addr_offset * opb; j < addr_offset * opb + pb; j += bpc)
-          {
-            int k;
-
-            if (bpc > 1 && inf->display_endian == BFD_ENDIAN_LITTLE)
-              {
-                for (k = bpc - 1; k >= 0; k--)
-                  {
-                    sprintf(hexdump, "%02x", (unsigned) data[j + k]);
-                    hexString += hexdump;
-                    hexString += " ";
-                  }
-              }
-            else
-              {
-                for (k = 0; k < bpc; k++)
-                  {
-                    sprintf(hexdump, "%02x", (unsigned) data[j + k]);
-                    hexString += hexdump;
-                    hexString += " ";
-                  }
-              }
-          }
-
-        // Separate raw data from instruction by extra space.
-        while (pb < octets)
-          {
-            bfd_vma j;
-            char *s;
-
-            j = addr_offset * opb + pb;
-
-            bfd_sprintf_vma(aux->abfd, buf, section->vma + j / opb);
-            for (s = buf + skip_addr_chars; *s == '0'; s++)
-              *s = ' ';
-            if (*s == '\0')
-              *--s = '0';
-
-            pb += octets_per_line;
-            if (pb > octets)
-              pb = octets;
-            for (; j < addr_offset * opb + pb; j += bpc)
-              {
-                int k;
-
-                if (bpc > 1 && inf->display_endian == BFD_ENDIAN_LITTLE)
-                  {
-                    for (k = bpc - 1; k >= 0; k--)
-                      {
-                        sprintf(hexdump, "%02x", (unsigned) data[j + k]);
-                        hexString += hexdump;
-                        hexString += " ";
-                      }
-                  }
-                else
-                  {
-                    for (k = 0; k < bpc; k++)
-                      {
-                        sprintf(hexdump, "%02x", (unsigned) data[j + k]);
-                        hexString += hexdump;
-                        hexString += " ";
-                      }
-                  }
-              }
-          }
+        // two hex digits and a separator for each octet
+        hexString.resize(octets * 3);
+        ByteTools::hex_encode(data + addr_offset * opb - base, octets, bpc,
+                              bpc > 1 && inf->display_endian == BFD_ENDIAN_LITTLE,
+                              &hexString[0]);
 
         // init code line and append to function
-        crtLine->setLine(disassemble_line);
+        crtLine->setVma(section->vma + addr_offset);
+        crtLine->setLength(octets / opb);
+        crtLine->setLine(aux->text);
         crtLine->setHexValue(hexString);
         f->addCodeLine(crtLine);
 
-        disassemble_line = "";
+        aux->text.clear();
 
-        while ((*relppp) < relppend
-               && (**relppp)->address < rel_offset + addr_offset + octets / opb)
+        while (!relocs->atEnd()
+               && relocs->current()->address < addr_offset + octets / opb)
           {
             arelent *q;
+            const char *sym_name = NULL;
 
-            q = **relppp;
+            q = relocs->current();
 
             if (q->sym_ptr_ptr == NULL || *q->sym_ptr_ptr == NULL) {}
             else
               {
-                const char *sym_name;
-
                 sym_name = bfd_asymbol_name(*q->sym_ptr_ptr);
                 if (sym_name != NULL && *sym_name != '\0')
                   {}
@@ -613,59 +675,86 @@ namespace Disassembly
                   }
               }
 
-            if (q->addend)
-              {
-                bfd_signed_vma addend = q->addend;
-                if (addend < 0)
-                  addend = -addend;
-              }
+            // only pointers are kept, the text is made when it's shown
+            crtLine->addReloc(RelocNames::name(aux->abfd, q), sym_name,
+                              q->addend, q->address);
 
-            ++(*relppp);
+            relocs->next();
           }
 
         addr_offset += octets / opb;
       }
-    if (sfile.buffer)
+
+    aux->line = NULL;
+  }
+
+  // reads *size* octets of a section starting at *offset*, the
+  // relocations are taken from the file's table
+  bfd_boolean load_window (bfd *abfd, asection *section, const RelocTable &relocs,
+                           bfd_vma offset, bfd_size_type size, section_job *job)
+  {
+    job->section = section;
+    job->data = NULL;
+    job->offset = offset;
+    job->size = size;
+    job->relocs = NULL;
+    job->start_address = (bfd_vma) -1;
+    job->stop_address = (bfd_vma) -1;
+
+    if (size == 0)
+      return FALSE;
+
+    job->data = (bfd_byte *) malloc(size);
+
+    if (!bfd_get_section_contents(abfd, section, job->data, offset, size))
       {
-        free(sfile.buffer);
-        sfile.buffer = NULL;
+        free(job->data);
+        job->data = NULL;
+        return FALSE;
       }
 
+    job->relocs = &relocs;
+
+    return TRUE;
   }
 
-  // disassembles sections
-  void disassemble_section (bfd *abfd, asection *section, void *inf)
+  // reads the contents and sorted relocations of a section
+  bfd_boolean load_section (bfd *abfd, asection *section, const RelocTable &relocs, section_job *job)
+  {
+    return load_window(abfd, section, relocs, 0, bfd_get_section_size(section), job);
+  }
+
+  // disassembles one section, the functions found are kept in the job
+  void disassemble_section (struct disassemble_info *pinfo, section_job *job)
   {
     const struct elf_backend_data * bed;
     bfd_vma                      sign_adjust = 0;
-    struct disassemble_info *    pinfo = (struct disassemble_info *) inf;
-    struct disasm_info * paux;
+    struct disasm_info *         paux = (struct disasm_info *) pinfo->application_data;
+    bfd *                        abfd = paux->abfd;
+    asection *                   section = job->section;
+    asymbol **                   sorted_syms = paux->sorted_syms;
+    long                         sorted_symcount = paux->sorted_symcount;
     unsigned int                 opb = pinfo->octets_per_byte;
-    bfd_byte *                   data = NULL;
-    bfd_size_type                datasize = 0;
-    arelent **                   rel_pp = NULL;
-    arelent **                   rel_ppstart = NULL;
-    arelent **                   rel_ppend;
+    bfd_byte *                   data = job->data;
+    bfd_size_type                datasize = job->offset + job->size;
+    bfd_vma                      start_address = job->start_address;
+    bfd_vma                      stop_address = job->stop_address;
+    RelocTable::Cursor           relocs;
     bfd_vma                      stop_offset;
     asymbol *                    sym = NULL;
     long                         place = 0;
-    long                         rel_count;
-    bfd_vma                      rel_offset;
     unsigned long                addr_offset;
 
-    if (! process_section_p (section))
-      return;
-
-    datasize = bfd_get_section_size(section);
-    if (datasize == 0)
-      return;
-
     if (start_address == (bfd_vma) -1
         || start_address < section->vma)
       addr_offset = 0;
     else
       addr_offset = start_address - section->vma;
 
+    // nothing before the loaded window can be disassembled
+    if (addr_offset < job->offset / opb)
+      addr_offset = job->offset / opb;
+
     if (stop_address == (bfd_vma) -1)
       stop_offset = datasize / opb;
     else
@@ -681,64 +770,23 @@ namespace Disassembly
     if (addr_offset >= stop_offset)
       return;
 
-    // Decide which set of relocs to use.  Load them if necessary.
-    paux = (struct disasm_info *) pinfo->application_data;
-    if (paux->dynrelbuf)
-      {
-        rel_pp = paux->dynrelbuf;
-        rel_count = paux->dynrelcount;
-        rel_offset = section->vma;
-      }
-    else
-      {
-        rel_count = 0;
-        rel_pp = NULL;
-        rel_offset = 0;
-
-        if ((section->flags & SEC_RELOC) != 0)
-          {
-            long relsize;
-
-            relsize = bfd_get_reloc_upper_bound(abfd, section);
-            if (relsize < 0)
-              return;
-
-            if (relsize > 0)
-              {
-                rel_ppstart = rel_pp = (arelent **) malloc(relsize);
-                rel_count = bfd_canonicalize_reloc(abfd, section, rel_pp, syms);
-                if (rel_count < 0)
-                  return;
-
-                // Sort the relocs by address.
-                qsort(rel_pp, rel_count, sizeof(arelent *), compare_relocs);
-              }
-          }
-      }
-    rel_ppend = rel_pp + rel_count;
-
-    data = (bfd_byte *) malloc(datasize);
-
-    bfd_get_section_contents(abfd, section, data, 0, datasize);
-
     paux->sec = section;
     pinfo->buffer = data;
-    pinfo->buffer_vma = section->vma;
-    pinfo->buffer_length = datasize;
+    pinfo->buffer_vma = section->vma + job->offset / opb;
+    pinfo->buffer_length = job->size;
     pinfo->section = section;
 
     // Skip over the relocs belonging to addresses below the start address.
-    while (rel_pp < rel_ppend
-           && (*rel_pp)->address < rel_offset + addr_offset)
-      ++rel_pp;
+    if (job->relocs != NULL)
+      relocs = job->relocs->cursor(section, addr_offset);
 
     // Find the nearest symbol forwards from our current position
     paux->require_sec = TRUE;
     sym = (asymbol *) find_symbol_for_address(section->vma + addr_offset,
-                                              (struct disassemble_info *) inf,
-                                              &place);
+                                              pinfo, &place);
     paux->require_sec = FALSE;
 
+    std::vector<InsnDecoder::Insn> insns;
     // PR 9774: If the target used signed addresses then we must make
     // sure that we sign extend the value that we calculate for 'addr'
     // in the loop below.
@@ -757,6 +805,10 @@ namespace Disassembly
         asymbol *nextsym;
         bfd_vma nextstop_offset;
 
+        // a large .text would keep a cancelled run going for long
+        if (paux->cancel != NULL && paux->cancel->load())
+          break;
+
         addr = section->vma + addr_offset;
         addr = ((addr & ((sign_adjust << 1) - 1)) ^ sign_adjust) - sign_adjust;
 
@@ -783,7 +835,8 @@ namespace Disassembly
 
         // new function
         Function *f = new Function();
-        f->setName(sym->name);
+        if (sym != NULL)
+          f->setName(sym->name);
 
         if (sym != NULL && bfd_asymbol_value(sym) > addr)
           nextsym = sym;
@@ -821,54 +874,129 @@ namespace Disassembly
             || nextstop_offset <= addr_offset)
           nextstop_offset = stop_offset;
 
+        // one decode of the whole function up front, the formatting loop
+        // takes the operand targets from it
+        bool decoded = InsnDecoder::supported(abfd);
+
+        if (decoded)
+          {
+            insns.clear();
+            InsnDecoder::scan(abfd, data + addr_offset * opb - job->offset,
+                              (nextstop_offset - addr_offset) * opb,
+                              section->vma + addr_offset, insns);
+            f->reserveCodeLines(insns.size());
+          }
+
         disassemble_bytes(pinfo, paux->disassemble_fn, TRUE, data,
                           addr_offset, nextstop_offset,
-                          rel_offset, &rel_pp, rel_ppend, f);
+                          &relocs, f,
+                          decoded ? &insns : NULL);
 
-        crtFile->addFunction(f);
+        job->functions.push_back(f);
+
+        if (paux->channel != NULL && (paux->cancel == NULL || !paux->cancel->load()))
+          paux->channel->push(paux->file, f);
 
         addr_offset = nextstop_offset;
         sym = nextsym;
       }
-
-    if (data)
-      {
-        free(data);
-        data = NULL;
-      }
-
-    if (rel_ppstart)
-      {
-        free(rel_ppstart);
-        rel_ppstart = NULL;
-      }
   }
 
   // adds a section to be disassembled
   void add_section (std::string sec)
   {
-    sections.push_back(sec);
+    std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+
+    if (std::find(sections.begin(), sections.end(), sec) == sections.end())
+      sections.push_back(sec);
   }
 
-  // Disassemble the contents of an object file.
-  void disassemble_data (ELFFile *E)
+  void set_section_filter (std::vector<std::string> filter)
   {
-    struct disassemble_info disasm_info;
-    struct disasm_info aux;
-    long i;
+    std::lock_guard<std::recursive_mutex> lock(bfd_lock());
 
-    start_address = (bfd_vma) -1;
-    stop_address = (bfd_vma) -1;
+    sections = filter;
+  }
 
-    bfd *abfd = E->getBfd();
-    syms = E->getSyms();
-    symcount = E->getSymcount();
-    dynsyms = E->getDSyms();
-    dynsymcount = E->getDynSymcount();
-    synthsyms = E->getSynthsyms();
-    synthcount = E->getSynthcount();
+  std::vector<std::string> get_section_filter ()
+  {
+    std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+
+    return sections;
+  }
+
+  // prepares the disassemble_info of one worker
+  void init_info (bfd *abfd, disassembler_ftype disassemble_fn,
+                  asymbol **sorted_syms, long sorted_symcount,
+                  struct disassemble_info *pinfo, struct disasm_info *paux)
+  {
+    init_disassemble_info(pinfo, paux, (fprintf_ftype) disassemble_print);
+    pinfo->application_data = (void *) paux;
+
+    paux->abfd = abfd;
+    paux->sec = NULL;
+    paux->require_sec = FALSE;
+    paux->disassemble_fn = disassemble_fn;
+    paux->reloc = NULL;
+    paux->sorted_syms = sorted_syms;
+    paux->sorted_symcount = sorted_symcount;
+    paux->dynrelocs = NULL;
+    paux->line = NULL;
+    paux->channel = NULL;
+    paux->cancel = NULL;
+    paux->file = NULL;
+
+    pinfo->print_address_func = print_address;
+    pinfo->symbol_at_address_func = symbol_at_address;
+
+    pinfo->flavour = bfd_get_flavour(abfd);
+    pinfo->arch = bfd_get_arch(abfd);
+    pinfo->mach = bfd_get_mach(abfd);
+    pinfo->disassembler_options = NULL;
+    pinfo->octets_per_byte = bfd_octets_per_byte(abfd);
+    pinfo->skip_zeroes = DEFAULT_SKIP_ZEROES;
+    pinfo->skip_zeroes_at_end = DEFAULT_SKIP_ZEROES_AT_END;
+    // tell the disassembler about relocations in relocatable files, the
+    // same as objdump -dr; the target may still change it below
+    pinfo->disassembler_needs_relocs =
+        (bfd_get_file_flags(abfd) & (EXEC_P | DYNAMIC)) == 0;
+
+    if (endian != BFD_ENDIAN_UNKNOWN)
+      pinfo->display_endian = pinfo->endian = endian;
+    else if (bfd_big_endian(abfd))
+      pinfo->display_endian = pinfo->endian = BFD_ENDIAN_BIG;
+    else if (bfd_little_endian(abfd))
+      pinfo->display_endian = pinfo->endian = BFD_ENDIAN_LITTLE;
+    else
+      pinfo->endian = BFD_ENDIAN_UNKNOWN;
+
+    // Allow the target to customize the info structure.  */
+    disassemble_init_for_target(pinfo);
+
+    pinfo->symtab = sorted_syms;
+    pinfo->symtab_size = sorted_symcount;
+  }
+
+  // the symbols the disassembler can use, sorted by address; they are
+  // sorted the first time and the file keeps the array
+  long sort_file_symbols (ELFFile *E, asymbol ***sorted)
+  {
+    asymbol **sorted_syms;
+    long sorted_symcount;
+    long i;
 
-    crtFile = E;
+    if (E->getSortedSyms() != NULL)
+      {
+        *sorted = E->getSortedSyms();
+        return E->getSortedSymcount();
+      }
+
+    asymbol **syms = E->getSyms();
+    long symcount = E->getSymcount();
+    asymbol **dynsyms = E->getDSyms();
+    long dynsymcount = E->getDynSymcount();
+    asymbol *synthsyms = E->getSynthsyms();
+    long synthcount = E->getSynthcount();
 
     // We make a copy of syms to sort.  We don't want to sort syms
     // because that will screw up the relocs.
@@ -887,21 +1015,18 @@ namespace Disassembly
       }
 
     // Sort the symbols into section and symbol order.
-    qsort(sorted_syms, sorted_symcount, sizeof(asymbol *), compare_symbols);
-
-    init_disassemble_info(&disasm_info, NULL, (fprintf_ftype) disassemble_print);
-    disasm_info.application_data = (void *) &aux;
+    sort_symbols(sorted_syms, sorted_symcount);
 
-    aux.abfd = abfd;
-    aux.require_sec = FALSE;
-    aux.dynrelbuf = NULL;
-    aux.dynrelcount = 0;
-    aux.reloc = NULL;
+    E->setSortedSyms(sorted_syms, sorted_symcount);
 
-    disasm_info.print_address_func = print_address;
-    disasm_info.symbol_at_address_func = symbol_at_address;
+    *sorted = sorted_syms;
+    return sorted_symcount;
+  }
 
-    if (endian != BFD_ENDIAN_UNKNOWN)
+  // overrides the file's byte order when an endianness is forced
+  static void apply_endian (bfd *abfd)
+  {
+    if (endian != BFD_ENDIAN_UNKNOWN && abfd->xvec->byteorder != endian)
       {
         struct bfd_target *xvec;
 
@@ -910,72 +1035,218 @@ namespace Disassembly
         xvec->byteorder = endian;
         abfd->xvec = xvec;
       }
+  }
+
+  // Disassemble the contents of an object file.
+  void disassemble_data (ELFFile *E, const std::atomic<bool> *cancel, FunctionChannel *channel)
+  {
+    std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+    asymbol **sorted_syms;
+    long sorted_symcount;
+
+    bfd *abfd = E->getBfd();
+    const RelocTable &relocs = E->getRelocs();
+
+    sorted_symcount = sort_file_symbols(E, &sorted_syms);
+
+    apply_endian(abfd);
 
     // Use libopcodes to locate a suitable disassembler.
-    aux.disassemble_fn = disassembler(abfd);
-    if (!aux.disassemble_fn)
+    disassembler_ftype disassemble_fn = disassembler(abfd);
+    if (!disassemble_fn)
       {
         std::cerr << "can't disassemble for architecture "
                   << bfd_printable_arch_mach(bfd_get_arch(abfd), 0) << std::endl;
         return;
       }
 
-    disasm_info.flavour = bfd_get_flavour(abfd);
-    disasm_info.arch = bfd_get_arch(abfd);
-    disasm_info.mach = bfd_get_mach(abfd);
-    disasm_info.disassembler_options = NULL;
-    disasm_info.octets_per_byte = bfd_octets_per_byte(abfd);
-    disasm_info.skip_zeroes = DEFAULT_SKIP_ZEROES;
-    disasm_info.skip_zeroes_at_end = DEFAULT_SKIP_ZEROES_AT_END;
-    disasm_info.disassembler_needs_relocs = FALSE;
-
-    if (bfd_big_endian(abfd))
-      endian = disasm_info.display_endian = disasm_info.endian = BFD_ENDIAN_BIG;
-    else if (bfd_little_endian(abfd))
-      endian = disasm_info.display_endian = disasm_info.endian = BFD_ENDIAN_LITTLE;
-    else
-      endian = disasm_info.endian = BFD_ENDIAN_UNKNOWN;
+    // bfd isn't thread safe, so every selected section is read up front
+    std::vector<bool> selected = select_sections(abfd);
+    std::vector<section_job> jobs;
+    const RelocTable *dynrelocs = NULL;
 
-    // Allow the target to customize the info structure.  */
-    disassemble_init_for_target(&disasm_info);
+    for (asection *section = abfd->sections; section != NULL; section = section->next)
+      {
+        section_job job;
 
-    // Pre-load the dynamic relocs if we are going
-    // to be dumping them along with the disassembly.
+        if (section->index < selected.size() && selected[section->index]
+            && load_section(abfd, section, relocs, &job))
+          {
+            jobs.push_back(job);
 
-    /*long relsize = bfd_get_dynamic_reloc_upper_bound(abfd);
+            // the dynamic relocations are only read for files whose
+            // PLT is disassembled
+            if (dynrelocs == NULL && is_plt_section(section))
+              dynrelocs = &E->getDynRelocs();
+          }
+      }
 
-    if (relsize < 0)
-      bfd_fatal(bfd_get_filename(abfd));
+    // sections are handed out to the workers one at a time
+    std::atomic<size_t> next(0);
+    size_t threads = worker_count(jobs.size());
 
-    if (relsize > 0)
+    auto worker = [&]()
       {
-        aux.dynrelbuf = (arelent **) malloc(relsize);
-        aux.dynrelcount = bfd_canonicalize_dynamic_reloc(abfd,
-                                                         aux.dynrelbuf,
-                                                         dynsyms);
-        if (aux.dynrelcount < 0)
-          bfd_fatal(bfd_get_filename(abfd));
-
-        // Sort the relocs by address.
-        qsort(aux.dynrelbuf, aux.dynrelcount, sizeof(arelent *),
-              compare_relocs);
-      }*/
-    disasm_info.symtab = sorted_syms;
-    disasm_info.symtab_size = sorted_symcount;
-
-    bfd_map_over_sections(abfd, disassemble_section, &disasm_info);
-
-    if (aux.dynrelbuf)
+        struct disassemble_info info;
+        struct disasm_info aux;
+
+        init_info(abfd, disassemble_fn, sorted_syms, sorted_symcount, &info, &aux);
+        aux.dynrelocs = dynrelocs;
+        aux.channel = channel;
+        aux.file = E;
+        aux.cancel = cancel;
+
+        for (size_t j = next++; j < jobs.size(); j = next++)
+          {
+            if (cancel != nullptr && cancel->load())
+              break;
+
+            disassemble_section(&info, &jobs[j]);
+          }
+      };
+
+    std::vector<std::thread> workers;
+
+    for (size_t t = 1; t < threads; ++t)
+      workers.push_back(std::thread(worker));
+
+    if (threads)
+      worker();
+
+    for (std::thread &t : workers)
+      t.join();
+
+    // functions keep the section order no matter which worker made them
+    for (section_job &job : jobs)
       {
-        free(aux.dynrelbuf);
-        aux.dynrelbuf = NULL;
+        for (Function *f : job.functions)
+          E->addFunction(f);
+
+        free(job.data);
       }
+  }
+
+  // finds the code section holding *vma*
+  static asection *code_section_at (bfd *abfd, bfd_vma vma)
+  {
+    unsigned int opb = bfd_octets_per_byte(abfd);
 
-    if (sorted_syms)
+    for (asection *section = abfd->sections; section != NULL; section = section->next)
+      if ((section->flags & SEC_CODE) != 0
+          && (section->flags & SEC_HAS_CONTENTS) != 0
+          && vma >= section->vma
+          && vma < section->vma + bfd_get_section_size(section) / opb)
+        return section;
+
+    return NULL;
+  }
+
+  // returns the address of the closest symbol of *section* at or before *vma*
+  static bfd_vma symbol_before (asection *section, asymbol **sorted_syms,
+                                long sorted_symcount, bfd_vma vma)
+  {
+    long min = 0;
+    long max = sorted_symcount;
+
+    // the symbols are sorted by address, find the first one past vma
+    while (min < max)
       {
-        free(sorted_syms);
-        sorted_syms = NULL;
+        long mid = min + (max - min) / 2;
+
+        if (bfd_asymbol_value(sorted_syms[mid]) <= vma)
+          min = mid + 1;
+        else
+          max = mid;
       }
+
+    while (--min >= 0)
+      if (sorted_syms[min]->section == section)
+        return bfd_asymbol_value(sorted_syms[min]);
+
+    return section->vma;
   }
 
+  // Disassemble the code between *start* and *stop* only. The window
+  // begins at the instruction holding *start*: close to a symbol it is
+  // found by walking from the symbol, farther away by decoding a short
+  // stretch before *start*, which is enough for the instruction stream to
+  // fall back in step. The caller owns the returned functions.
+  std::vector<Function *> disassemble_range (ELFFile *E, bfd_vma start, bfd_vma stop)
+  {
+    std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+    std::vector<Function *> functions;
+    asymbol **sorted_syms;
+    long sorted_symcount;
+    section_job job;
+
+    bfd *abfd = E->getBfd();
+    asection *section = code_section_at(abfd, start);
+
+    if (section == NULL || stop <= start)
+      return functions;
+
+    unsigned int opb = bfd_octets_per_byte(abfd);
+    bfd_vma end = section->vma + bfd_get_section_size(section) / opb;
+
+    if (stop > end)
+      stop = end;
+
+    sorted_symcount = sort_file_symbols(E, &sorted_syms);
+
+    // resync point, at or before start
+    bfd_vma from = symbol_before(section, sorted_syms, sorted_symcount, start);
+
+    if (start - from > RESYNC_DISTANCE)
+      {
+        if (InsnDecoder::supported(abfd))
+          from = start - RESYNC_BACKOFF;
+        else
+          from = start;
+      }
+
+    bfd_vma to = stop + MAX_INSN_OCTETS / opb;
+
+    if (to > end)
+      to = end;
+
+    apply_endian(abfd);
+
+    disassembler_ftype disassemble_fn = disassembler(abfd);
+
+    if (disassemble_fn == NULL
+        || !load_window(abfd, section, E->getRelocs(), (from - section->vma) * opb,
+                        (to - from) * opb, &job))
+      return functions;
+
+    // start at the last instruction boundary not past start
+    bfd_vma begin = from;
+
+    if (InsnDecoder::supported(abfd))
+      {
+        std::vector<InsnDecoder::Insn> insns;
+
+        InsnDecoder::scan(abfd, job.data, (start - from + 1) * opb, from, insns);
+        for (const InsnDecoder::Insn &I : insns)
+          if (I.vma <= start)
+            begin = I.vma;
+      }
+
+    job.start_address = begin;
+    job.stop_address = stop;
+
+    struct disassemble_info info;
+    struct disasm_info aux;
+
+    init_info(abfd, disassemble_fn, sorted_syms, sorted_symcount, &info, &aux);
+    if (is_plt_section(section))
+      aux.dynrelocs = &E->getDynRelocs();
+
+    disassemble_section(&info, &job);
+
+    functions.swap(job.functions);
+
+    free(job.data);
+
+    return functions;
+  }
 }
@@ -10,49 +10,104 @@
 #include <libiberty/safe-ctype.h>
 
 #include <iostream>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <cstring>
 
 #include "elffile.h"
+#include "functionchannel.h"
+#include "insndecoder.h"
 #include "tools.h"
 #include "elf-bfd.h"
 
 /* Extra info to pass to the section disassembler and address printing
-   function.  */
+   function.  Every worker thread has its own copy.  */
 struct disasm_info
 {
   bfd *              abfd;
   asection *         sec;
   bfd_boolean        require_sec;
-  arelent **         dynrelbuf;
-  long               dynrelcount;
   disassembler_ftype disassemble_fn;
   arelent *          reloc;
+
+  asymbol **         sorted_syms;
+  long               sorted_symcount;
+
+  // set when GOT slots can be named, see label_got_slot
+  const RelocTable * dynrelocs;
+
+  CodeLine *         line;
+  std::string        text;
+
+  // finished functions are also pushed here when it's set
+  FunctionChannel *  channel;
+  ELFFile *          file;
+
+  // a section stops at the next function once this is set
+  const std::atomic<bool> * cancel;
+};
+
+/* One section to disassemble.  Contents are read before the workers
+   start, since bfd can't be used from several threads, the relocations
+   point into the file's RelocTable.
+   *data* may hold only a window of the section, *size* octets starting
+   at section offset *offset*.  */
+struct section_job
+{
+  asection *             section;
+  bfd_byte *             data;
+  bfd_vma                offset;
+  bfd_size_type          size;
+  bfd_vma                start_address;
+  bfd_vma                stop_address;
+  const RelocTable *     relocs;
+  std::vector<Function *> functions;
 };
 
 namespace Disassembly
 {
-  void print_to_string(std::string);
-  int ATTRIBUTE_PRINTF_2 disassemble_print (SFILE *, const char *, ...);
+  void print_to_string(struct disassemble_info *, std::string);
+  int ATTRIBUTE_PRINTF_2 disassemble_print (void *, const char *, ...);
 
   int symbol_at_address(bfd_vma, struct disassemble_info *);
   void print_addr_with_sym(bfd *, asection *, asymbol *, bfd_vma, struct disassemble_info *);
+  void label_line(asymbol *, bfd_vma, struct disassemble_info *);
+  void label_got_slot(bfd_vma, struct disassemble_info *);
+  bool is_plt_section(asection *);
   asymbol *find_symbol_for_address(bfd_vma, struct disassemble_info *, long *);
   void print_value(bfd_vma, struct disassemble_info *);
   void print_addr(bfd_vma, struct disassemble_info *);
   void print_address(bfd_vma, struct disassemble_info *);
 
   long remove_useless_symbols (asymbol **, long);
-  int compare_relocs(const void *, const void *);
   bfd_boolean process_section_p(asection *);
+  std::vector<bool> select_sections(bfd *);
   void disassemble_bytes(struct disassemble_info *, disassembler_ftype, bfd_boolean, bfd_byte *,
-                         bfd_vma, bfd_vma, bfd_vma, arelent ***, arelent **, Function *);
-  void disassemble_section(bfd *, asection *, void *);
-
+                         bfd_vma, bfd_vma, bfd_vma, arelent ***, arelent **, Function *,
+                         const std::vector<InsnDecoder::Insn> * = NULL);
+  bfd_boolean load_window(bfd *, asection *, const RelocTable &, bfd_vma, bfd_size_type, section_job *);
+  bfd_boolean load_section(bfd *, asection *, const RelocTable &, section_job *);
+  void disassemble_section(struct disassemble_info *, section_job *);
 
+  // sections to disassemble, by name or fnmatch pattern
+  // with no filter every code section is disassembled; the filter is
+  // shared by every run, changing it waits for a running one to finish
   void add_section (std::string);
-  void disassemble_data(ELFFile *);
+  void set_section_filter (std::vector<std::string>);
+  std::vector<std::string> get_section_filter ();
+
+  void init_info(bfd *, disassembler_ftype, asymbol **, long,
+                 struct disassemble_info *, struct disasm_info *);
+  // the array belongs to the file
+  long sort_file_symbols(ELFFile *, asymbol ***);
+  // stops at the next function once *cancel* is set, every
+  // function is pushed to *channel* as soon as it's disassembled
+  void disassemble_data(ELFFile *, const std::atomic<bool> * = nullptr,
+                        FunctionChannel * = nullptr);
+
+  // disassembles only the code between two addresses
+  std::vector<Function *> disassemble_range(ELFFile *, bfd_vma, bfd_vma);
 }
 
 #endif // DISASSEMBLEMODULE_H
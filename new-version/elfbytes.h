@@ -0,0 +1,40 @@
+#ifndef ELFBYTES_H
+#define ELFBYTES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Reading mapped ELF files without bfd: the structures of elf/external.h
+// are byte arrays in the file's byte order, these turn them into numbers
+// and check that what is read stays inside the mapping.
+namespace ElfBytes
+{
+  inline uint64_t get(const unsigned char *p, size_t n, bool big)
+  {
+    uint64_t v = 0;
+
+    if (big)
+      for (size_t i = 0; i < n; ++i)
+        v = (v << 8) | p[i];
+    else
+      for (size_t i = n; i > 0; --i)
+        v = (v << 8) | p[i - 1];
+
+    return v;
+  }
+
+  template <size_t N>
+  uint64_t field(bool big, const unsigned char (&f)[N])
+  {
+    return get(f, N, big);
+  }
+
+  // whether [p, p + n) is in the mapping of *size* bytes at *map*
+  inline bool inside(const unsigned char *map, size_t size,
+                     const unsigned char *p, size_t n)
+  {
+    return p >= map && n <= size && (size_t) (p - map) <= size - n;
+  }
+}
+
+#endif // ELFBYTES_H
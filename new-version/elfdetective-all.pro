@@ -0,0 +1,16 @@
+# the core library, then the window, the command line tool, the
+# benchmarks and the tests linking it
+
+TEMPLATE = subdirs
+
+SUBDIRS = core gui cli bench tests
+
+core.file = elfdetective-core.pro
+gui.file = ELFDetective.pro
+gui.depends = core
+cli.file = elfdetective-cli.pro
+cli.depends = core
+bench.file = elfdetective-bench.pro
+bench.depends = core
+tests.file = elfdetective-tests.pro
+tests.depends = core
@@ -0,0 +1,22 @@
+# times every phase of an analysis, see test-generator/run-benchmarks.sh;
+# the models only need QtCore, so no display is needed either
+
+TEMPLATE = app
+TARGET = elfdetective-bench
+
+CONFIG += console
+CONFIG -= app_bundle
+QT = core
+
+# the window builds the same models in this directory
+OBJECTS_DIR = .obj/bench
+MOC_DIR = .moc/bench
+
+include(linkcore.pri)
+
+SOURCES += bench.cpp \
+    functiontreemodel.cpp \
+    symbollistmodel.cpp
+
+HEADERS += functiontreemodel.h \
+    symbollistmodel.h
@@ -0,0 +1,14 @@
+# the analyzer without a window, for scripts and CI
+
+TEMPLATE = app
+TARGET = elfdetective-cli
+
+CONFIG += console
+CONFIG -= qt app_bundle
+QT -=
+
+OBJECTS_DIR = .obj/cli
+
+include(linkcore.pri)
+
+SOURCES += cli.cpp
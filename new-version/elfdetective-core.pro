@@ -0,0 +1,14 @@
+# the analysis core as a library, without Qt; see elfdetective.h
+
+TEMPLATE = lib
+TARGET = elfdetective-core
+
+CONFIG += staticlib
+CONFIG -= qt app_bundle
+QT -=
+
+OBJECTS_DIR = .obj/core
+
+include(core.pri)
+
+HEADERS += elfdetective.h
@@ -0,0 +1,15 @@
+# checks of the core that need neither Qt nor sample binaries; testcase
+# makes "make check" run them
+
+TEMPLATE = app
+TARGET = elfdetective-tests
+
+CONFIG += console testcase
+CONFIG -= qt app_bundle
+QT -=
+
+OBJECTS_DIR = .obj/tests
+
+include(linkcore.pri)
+
+SOURCES += tests.cpp
@@ -0,0 +1,50 @@
+#ifndef ELFDETECTIVE_H
+#define ELFDETECTIVE_H
+
+// The analysis core, the part of ELF Detective that doesn't need Qt or a
+// display. The window, the command line tool and the benchmarks all link
+// the elfdetective-core library and include only this header.
+//
+// Starting: call init_core() once before anything else, from any thread.
+//
+// Running a project: give AnalysisRun the executable and the objects as
+// ELFFiles (ELFFile(path, member, index) for archive members) and call
+// run(). It loads the files, binds the symbols with AddressBinding,
+// disassembles every file into Functions and CodeLines and builds the
+// FunctionDiff.
+// An AnalysisListener hears about each step from the running thread, and
+// a FunctionChannel gets every function as soon as it's done. The caller
+// owns the ELFFiles, the binding and the diff.
+//
+// Threads: bfd isn't thread safe, so every entry point that reaches it
+// (AnalysisRun::run, ELFFile::initBfd, ELFFile::archiveMembers, the
+// relocation tables, Disassembly::disassemble_data and disassemble_range,
+// the FunctionDiff and LinkVerifier) holds bfd_lock() while it runs; two
+// projects can be run from two threads, one after the other. What a run
+// produced can be read from any thread once it is handed over: the
+// listener's bindingReady() for AddressBinding and the symbol lists,
+// fileDone() or the channel for a file's functions, the end of run() for
+// the rest. FunctionDiff::compare and compareAll only read what the diff
+// loaded and can be used from several threads at once; a SectionMap or a
+// LayoutIndex belongs to one thread at a time.
+//
+// set_worker_count() bounds the threads every parallel pass uses.
+
+#include "tools.h"
+#include "elffile.h"
+#include "symbol.h"
+#include "function.h"
+#include "codeline.h"
+#include "addressbinding.h"
+#include "disassemblemodule.h"
+#include "functiondiff.h"
+#include "functionchannel.h"
+#include "linkverifier.h"
+#include "sectionmap.h"
+#include "layoutindex.h"
+#include "analysisrun.h"
+
+// raised whenever something above changes in a way callers must follow
+const int ELFDETECTIVE_API_VERSION = 1;
+
+#endif // ELFDETECTIVE_H
@@ -8,21 +8,78 @@ std::string ELFFile::getName()
   return this->filename;
 }
 
+std::string ELFFile::getPath() const
+{
+  return this->filepath;
+}
+
+std::string ELFFile::getMember() const
+{
+  return this->member;
+}
+
+std::vector<std::string> ELFFile::archiveMembers(const std::string &path)
+{
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+  std::vector<std::string> members;
+  bfd *ar = bfd_openr(path.c_str(), NULL);
+
+  if (ar == NULL)
+    return members;
+
+  if (bfd_check_format(ar, bfd_archive))
+    {
+      bfd *next = bfd_openr_next_archived_file(ar, NULL);
+
+      while (next != NULL)
+        {
+          members.push_back(bfd_get_filename(next));
+          next = bfd_openr_next_archived_file(ar, next);
+        }
+    }
+
+  bfd_close(ar);
+
+  return members;
+}
+
 int ELFFile::initBfd(int type)
 {
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+
   if (get_file_size (this->filepath.c_str()) < 1)
     {
       return BFD_FILE_SIZE;
     }
 
-  this->abfd = bfd_openr (this->filepath.c_str(), NULL);
-  this->abfd->flags |= BFD_DECOMPRESS;
+  if (this->member.empty())
+    this->abfd = bfd_openr (this->filepath.c_str(), NULL);
+  else
+    {
+      // the member's bfd belongs to the archive, which stays open with it
+      this->archive = bfd_openr (this->filepath.c_str(), NULL);
+
+      if (this->archive == NULL || !bfd_check_format(this->archive, bfd_archive))
+        return BFD_FILE_NULL;
+
+      bfd *next = bfd_openr_next_archived_file(this->archive, NULL);
+
+      for (size_t i = 0; next != NULL && i < this->memberIndex; ++i)
+        next = bfd_openr_next_archived_file(this->archive, next);
+
+      if (next != NULL && this->member != bfd_get_filename(next))
+        next = NULL;
+
+      this->abfd = next;
+    }
 
   if (this->abfd == NULL)
     {
       return BFD_FILE_NULL;
     }
 
+  this->abfd->flags |= BFD_DECOMPRESS;
+
   switch(type)
     {
     case ELF_EXE_FILE:
@@ -207,23 +264,50 @@ void ELFFile::setSynthcount(long synthcount)
   this->synthcount = synthcount;
 }
 
-void ELFFile::addFunction(Function *f)
+asymbol **ELFFile::getSortedSyms() const
 {
-  this->functions.push_back(f);
+  return this->sortedsyms;
 }
 
-std::vector<Function *> ELFFile::getFunctions() const
+long ELFFile::getSortedSymcount() const
 {
-  return this->functions;
+  return this->sortedcount;
+}
+
+void ELFFile::setSortedSyms(asymbol **sorted, long count)
+{
+  if (this->sortedsyms)
+    free(this->sortedsyms);
+
+  this->sortedsyms = sorted;
+  this->sortedcount = count;
+}
+
+const RelocTable &ELFFile::getRelocs()
+{
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+  std::call_once(this->relocsLoaded, [this]() {this->relocs.load(this->abfd, this->syms);});
+
+  return this->relocs;
+}
+
+const RelocTable &ELFFile::getDynRelocs()
+{
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+  this->getRelocs();
+  std::call_once(this->dynrelocsLoaded, [this]() {this->relocs.loadDynamic(this->abfd, this->dynsyms);});
+
+  return this->relocs;
 }
 
-void ELFFile::setView(QWidget *v)
+void ELFFile::addFunction(Function *f)
 {
-  this->view = v;
+  this->functions.push_back(f);
 }
-QWidget *ELFFile::getView() const
+
+std::vector<Function *> ELFFile::getFunctions() const
 {
-  return this->view;
+  return this->functions;
 }
 
 ELFFile::ELFFile() : symcount(0), dynsymcount(0), synthcount(0) {}
@@ -239,8 +323,18 @@ ELFFile::ELFFile(std::string fname)
   this->filename = token;
 }
 
+ELFFile::ELFFile(std::string fname, std::string mname, size_t index)
+  : ELFFile(fname)
+{
+  this->member = mname;
+  this->memberIndex = index;
+  this->filename += "(" + mname + ")";
+}
+
 ELFFile::~ELFFile()
 {
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+
   if (this->syms)
     {
       free(this->syms);
@@ -259,12 +353,24 @@ ELFFile::~ELFFile()
       this->synthsyms = nullptr;
     }
 
+  if (this->sortedsyms)
+    {
+      free(this->sortedsyms);
+      this->sortedsyms = nullptr;
+    }
+
   if (this->abfd)
     {
       bfd_close(this->abfd);
       this->abfd = nullptr;
     }
 
+  if (this->archive)
+    {
+      bfd_close(this->archive);
+      this->archive = nullptr;
+    }
+
   for (Function *f : this->functions)
     delete f;
 }
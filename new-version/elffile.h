@@ -4,7 +4,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <QWidget>
+#include <mutex>
 
 // this needs to be defined before any bfd.h include
 // due to a 'won't fix' bug
@@ -13,6 +13,7 @@
 #include <bfd.h>
 
 #include "function.h"
+#include "reloctable.h"
 
 const int BFD_FILE_SIZE = 10001;
 const int BFD_FILE_NULL = 10002;
@@ -27,6 +28,14 @@ class ELFFile
 {
 public:
   std::string getName();
+  std::string getPath() const;
+  // the archive member name, empty for a file of its own
+  std::string getMember() const;
+
+  // the members of an ar archive, in order; empty when it isn't one.
+  // ar allows two members of the same name, so a member is opened by its
+  // position in this list
+  static std::vector<std::string> archiveMembers(const std::string &);
 
   int initBfd(int type);
 
@@ -52,22 +61,40 @@ public:
   void setDynSymcount(long);
   void setSynthcount(long);
 
+  // the symbols sorted for the disassembler, kept once they are sorted
+  // so a window of code doesn't sort the whole table again; the file
+  // frees them
+  asymbol **getSortedSyms() const;
+  long getSortedSymcount() const;
+  void setSortedSyms(asymbol **, long);
+
+  // relocations of the loaded sections, read the first time they are asked
+  // for; the first call must not run alongside other uses of the bfd
+  const RelocTable &getRelocs();
+
+  // same table, with the dynamic relocations loaded as well; they are
+  // only needed to name PLT and GOT entries, so nothing reads them early
+  const RelocTable &getDynRelocs();
+
   void addFunction(Function *);
   std::vector<Function *> getFunctions() const;
 
-  void setView(QWidget *);
-  QWidget *getView() const;
-
   ELFFile();
   ELFFile(std::string);
+  // the member at an index of an ar archive, named "lib.a(member.o)"
+  ELFFile(std::string, std::string, size_t);
   virtual ~ELFFile();
 
 protected:
 private:
   std::string filepath;
   std::string filename;
+  std::string member;
+  size_t memberIndex = 0;
 
   bfd *abfd = nullptr;
+  // the archive holding abfd, for archive members
+  bfd *archive = nullptr;
   /* The symbol table.  */
   asymbol **syms = nullptr;
   /* The dynamic symbol table.  */
@@ -75,6 +102,9 @@ private:
   /* The synthetic symbol table.  */
   asymbol *synthsyms = nullptr;
 
+  asymbol **sortedsyms = nullptr;
+  long sortedcount = 0;
+
   /* Number of symbols in `syms'.  */
   long symcount;
   long dynsymcount;
@@ -82,7 +112,9 @@ private:
 
   std::vector<Function *> functions;
 
-  QWidget *view;
+  RelocTable relocs;
+  std::once_flag relocsLoaded;
+  std::once_flag dynrelocsLoaded;
 };
 
 #endif // ELFFILE_H
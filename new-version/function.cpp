@@ -1,9 +1,7 @@
 #include "function.h"
 
 Function::Function()
-{
-  this->hasRip = false;
-}
+{}
 
 Function::~Function()
 {
@@ -23,18 +21,6 @@ std::string Function::getName() const
 
 void Function::addCodeLine(CodeLine *c)
 {
-  if (this->hasRip)
-    {
-      CodeLine *last = this->codelines.back();
-      last->additionalInformation(c->getAddress());
-    }
-
-  std::size_t pos = c->getLine().find("(%rip)");
-  if (pos != std::string::npos)
-    this->hasRip = true;
-  else
-    this->hasRip = false;
-
   this->codelines.push_back(c);
 }
 
@@ -42,3 +28,18 @@ std::vector<CodeLine *> Function::getCodeLines()
 {
   return this->codelines;
 }
+
+size_t Function::getCodeLineCount() const
+{
+  return this->codelines.size();
+}
+
+CodeLine *Function::getCodeLine(size_t i) const
+{
+  return this->codelines[i];
+}
+
+void Function::reserveCodeLines(size_t count)
+{
+  this->codelines.reserve(count);
+}
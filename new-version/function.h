@@ -15,13 +15,16 @@ public:
 
   void addCodeLine(CodeLine *);
   std::vector<CodeLine *> getCodeLines();
+  size_t getCodeLineCount() const;
+  CodeLine *getCodeLine(size_t) const;
+
+  // room for *count* lines, when the boundary pass already knows it
+  void reserveCodeLines(size_t);
 
 protected:
 private:
   std::string name;
   std::vector<CodeLine *> codelines;
-
-  bool hasRip;
 };
 
 #endif // FUNCTION_H
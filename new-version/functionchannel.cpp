@@ -0,0 +1,41 @@
+#include <algorithm>
+
+#include "functionchannel.h"
+
+FunctionChannel::FunctionChannel()
+{}
+
+FunctionChannel::~FunctionChannel()
+{}
+
+void FunctionChannel::push(ELFFile *file, Function *function)
+{
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  this->items.push_back(Item{file, function});
+}
+
+std::vector<FunctionChannel::Item> FunctionChannel::take(size_t max)
+{
+  std::lock_guard<std::mutex> guard(this->lock);
+  size_t count = std::min(max, this->items.size());
+
+  std::vector<Item> taken(this->items.begin(), this->items.begin() + count);
+  this->items.erase(this->items.begin(), this->items.begin() + count);
+
+  return taken;
+}
+
+size_t FunctionChannel::pending() const
+{
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  return this->items.size();
+}
+
+void FunctionChannel::clear()
+{
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  this->items.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef FUNCTIONCHANNEL_H
+#define FUNCTIONCHANNEL_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "elffile.h"
+#include "function.h"
+
+// Hands functions from the disassembler workers to the GUI thread as soon
+// as each one is done. Any number of threads may push, one thread takes.
+// A function is complete when it's pushed and isn't changed afterwards;
+// it still belongs to its file, the channel only passes the pointer.
+class FunctionChannel
+{
+public:
+  struct Item
+  {
+    ELFFile *file;
+    Function *function;
+  };
+
+  FunctionChannel();
+  ~FunctionChannel();
+
+  void push(ELFFile *, Function *);
+
+  // takes at most *max* of the waiting functions, oldest first
+  std::vector<Item> take(size_t max);
+  size_t pending() const;
+  void clear();
+
+private:
+  mutable std::mutex lock;
+  std::deque<Item> items;
+};
+
+#endif // FUNCTIONCHANNEL_H
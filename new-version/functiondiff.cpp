@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+
+#include "functiondiff.h"
+#include "bytetools.h"
+#include "tools.h"
+#include "elf-bfd.h"
+
+std::vector<LineDiff> FunctionDiff::compare(ELFFile *E, std::string name) const
+{
+  std::vector<LineDiff> diff;
+
+  auto objFile = this->placements.find(E);
+  if (objFile == this->placements.end())
+    return diff;
+
+  auto objIt = objFile->second.find(name);
+  if (objIt == objFile->second.end())
+    return diff;
+
+  auto exeIt = this->exeFunctions.find(objIt->second.exeVma);
+  if (exeIt == this->exeFunctions.end())
+    return diff;
+
+  const Placement &obj = objIt->second;
+  const Placement &exe = exeIt->second;
+  if (obj.function == nullptr || exe.function == nullptr)
+    return diff;
+
+  const LoadedSection &objSec = this->sections.at(obj.section);
+  const LoadedSection &exeSec = this->sections.at(exe.section);
+
+  bfd_vma objBase = obj.vma - obj.section->vma;
+  bfd_vma exeBase = exe.vma - exe.section->vma;
+
+  // whole function first, most of them match and then no line needs
+  // to be compared on its own
+  bool equal = false;
+  if (obj.size == exe.size && obj.size != 0
+      && objBase + obj.size <= objSec.data.size()
+      && exeBase + exe.size <= exeSec.data.size())
+    equal = ByteTools::find_masked_mismatch(&exeSec.data[exeBase], &objSec.data[objBase],
+                                            &objSec.mask[objBase], obj.size) == obj.size;
+
+  std::vector<CodeLine *> exeLines = exe.function->getCodeLines();
+  std::vector<CodeLine *> objLines = obj.function->getCodeLines();
+
+  diff = align(exeLines, exe.vma, objLines, obj.vma);
+
+  for (LineDiff &D : diff)
+    {
+      if (D.status == DIFF_MISSING)
+        continue;
+
+      const CodeLine *exeLine = exeLines[D.exeLine];
+      const CodeLine *objLine = objLines[D.objLine];
+      bfd_vma length = objLine->getLength();
+      bfd_vma objAt = objBase + D.offset;
+      bfd_vma exeAt = exeBase + D.offset;
+
+      if (exeLine->getLength() != objLine->getLength()
+          || objAt + length > objSec.data.size()
+          || exeAt + length > exeSec.data.size())
+        D.status = DIFF_MISMATCH;
+      else if (!equal && ByteTools::find_masked_mismatch(&exeSec.data[exeAt], &objSec.data[objAt],
+                                                         &objSec.mask[objAt], length) != length)
+        D.status = DIFF_MISMATCH;
+      else if (memchr(&objSec.mask[objAt], 0, length) != NULL)
+        D.status = DIFF_RELOCATED;
+    }
+
+  return diff;
+}
+
+std::vector<LineDiff> FunctionDiff::align(const std::vector<CodeLine *> &exeLines, bfd_vma exeStart,
+                                          const std::vector<CodeLine *> &objLines, bfd_vma objStart)
+{
+  std::vector<LineDiff> diff;
+  size_t i = 0, j = 0;
+
+  diff.reserve(std::max(exeLines.size(), objLines.size()));
+
+  // both sides are sorted by address, walk them together by offset
+  while (i < exeLines.size() || j < objLines.size())
+    {
+      bfd_vma exeOffset = (i < exeLines.size()) ? exeLines[i]->getVma() - exeStart : (bfd_vma) -1;
+      bfd_vma objOffset = (j < objLines.size()) ? objLines[j]->getVma() - objStart : (bfd_vma) -1;
+      LineDiff D;
+
+      if (exeOffset < objOffset)
+        {
+          D.offset = exeOffset;
+          D.exeLine = i++;
+          D.objLine = -1;
+          D.status = DIFF_MISSING;
+        }
+      else if (objOffset < exeOffset)
+        {
+          D.offset = objOffset;
+          D.exeLine = -1;
+          D.objLine = j++;
+          D.status = DIFF_MISSING;
+        }
+      else
+        {
+          D.offset = objOffset;
+          D.exeLine = i++;
+          D.objLine = j++;
+          D.status = DIFF_MATCH;
+        }
+
+      diff.push_back(D);
+    }
+
+  return diff;
+}
+
+std::vector<FunctionReport> FunctionDiff::compareAll() const
+{
+  std::vector<FunctionReport> reports;
+
+  for (ELFFile *E : this->objfiles)
+    {
+      auto file = this->placements.find(E);
+      if (file == this->placements.end())
+        continue;
+
+      size_t first = reports.size();
+
+      for (auto it = file->second.begin(); it != file->second.end(); ++it)
+        {
+          FunctionReport R;
+
+          R.name = it->first;
+          R.file = E->getName();
+          reports.push_back(R);
+        }
+
+      std::sort(reports.begin() + first, reports.end(),
+                [](const FunctionReport &a, const FunctionReport &b) {return a.name < b.name;});
+    }
+
+  // every function is independent, the workers take them one at a time
+  std::vector<ELFFile *> owners;
+  for (ELFFile *E : this->objfiles)
+    if (this->placements.count(E))
+      owners.insert(owners.end(), this->placements.at(E).size(), E);
+
+  std::atomic<size_t> next(0);
+  size_t threads = worker_count(reports.size());
+
+  auto worker = [&]()
+    {
+      for (size_t k = next++; k < reports.size(); k = next++)
+        {
+          FunctionReport &R = reports[k];
+
+          R.lines = R.relocated = R.mismatches = R.missing = 0;
+
+          for (const LineDiff &D : this->compare(owners[k], R.name))
+            {
+              ++R.lines;
+              if (D.status == DIFF_RELOCATED)
+                ++R.relocated;
+              else if (D.status == DIFF_MISMATCH)
+                ++R.mismatches;
+              else if (D.status == DIFF_MISSING)
+                ++R.missing;
+            }
+        }
+    };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t = 1; t < threads; ++t)
+    workers.push_back(std::thread(worker));
+
+  if (threads)
+    worker();
+
+  for (std::thread &t : workers)
+    t.join();
+
+  return reports;
+}
+
+std::string FunctionDiff::statusName(int status)
+{
+  switch (status)
+    {
+    case DIFF_MATCH:
+      return "Match";
+    case DIFF_RELOCATED:
+      return "Match after relocation";
+    case DIFF_MISMATCH:
+      return "Mismatch";
+    case DIFF_MISSING:
+      return "No instruction at this offset";
+    default:
+      return "";
+    }
+}
+
+// reads the code sections of a file and indexes its function symbols; the
+// executable has to be read before the objects
+void FunctionDiff::loadFile(ELFFile *E, bool object)
+{
+  bfd *abfd = E->getBfd();
+
+  for (asection *section = abfd->sections; section != NULL; section = section->next)
+    if ((section->flags & SEC_CODE) != 0 && (section->flags & SEC_HAS_CONTENTS) != 0)
+      this->loadSection(E, section, object);
+
+  // several executable functions can have the same name, they are told
+  // apart by where they start; every section of an object starts at 0
+  // so its functions are found by name
+  std::unordered_map<std::string, Function *> byName;
+  std::unordered_map<bfd_vma, Function *> byVma;
+
+  for (Function *f : E->getFunctions())
+    {
+      if (object)
+        byName.emplace(f->getName(), f);
+      else if (f->getCodeLineCount() != 0)
+        byVma.emplace(f->getCodeLine(0)->getVma(), f);
+    }
+
+  std::unordered_map<asection *, bfd_vma> sectionsPlaced;
+  if (object && this->AB != nullptr)
+    sectionsPlaced = this->AB->placeSections(E);
+
+  asymbol **current = E->getSyms();
+
+  for (long i = 0; i < E->getSymcount(); ++i, ++current)
+    {
+      asymbol *sym = *current;
+
+      if (sym == NULL || (sym->flags & BSF_FUNCTION) == 0)
+        continue;
+
+      if (bfd_is_und_section(sym->section)
+          || this->sections.find(sym->section) == this->sections.end())
+        continue;
+
+      std::string name = bfd_asymbol_name(sym);
+      Placement P;
+
+      P.section = sym->section;
+      P.vma = bfd_asymbol_value(sym);
+      P.size = ((elf_symbol_type *) sym)->internal_elf_sym.st_size;
+
+      if (!object)
+        {
+          auto f = byVma.find(P.vma);
+          if (f == byVma.end())
+            continue;
+
+          P.function = f->second;
+          P.exeVma = P.vma;
+          this->exeFunctions.emplace(P.vma, P);
+
+          auto named = this->exeNames.emplace(name, P.vma);
+          if (!named.second && named.first->second != P.vma)
+            named.first->second = (bfd_vma) -1;
+
+          continue;
+        }
+
+      auto f = byName.find(name);
+      if (f == byName.end())
+        continue;
+
+      const Symbol *bound = nullptr;
+      if (this->AB != nullptr && (sym->flags & (BSF_GLOBAL | BSF_WEAK)) != 0)
+        {
+          bound = this->AB->findSymbol(name);
+          if (bound != nullptr && bound->defined_in != E->getName())
+            bound = nullptr;
+        }
+
+      P.function = f->second;
+      P.exeVma = exeAddress(sym->section, sym->value, sectionsPlaced, bound);
+
+      // a section holding only local functions can't be placed, its
+      // functions are then matched by name when that is unambiguous
+      if (P.exeVma == (bfd_vma) -1)
+        {
+          auto named = this->exeNames.find(name);
+          if (named != this->exeNames.end())
+            P.exeVma = named->second;
+        }
+
+      // the first definition wins, like in the disassembly
+      this->placements[E].emplace(name, P);
+    }
+}
+
+bfd_vma FunctionDiff::exeAddress(asection *section, bfd_vma offset,
+                                 const std::unordered_map<asection *, bfd_vma> &placed,
+                                 const Symbol *bound)
+{
+  auto it = placed.find(section);
+
+  if (it != placed.end())
+    return it->second + offset;
+
+  if (bound != nullptr && bound->placed)
+    return bound->exe_vma;
+
+  return (bfd_vma) -1;
+}
+
+// reads a section and, for objects, masks the bytes its relocations patch
+void FunctionDiff::loadSection(ELFFile *E, asection *section, bool object)
+{
+  bfd *abfd = E->getBfd();
+  bfd_size_type size = bfd_get_section_size(section);
+  LoadedSection &S = this->sections[section];
+
+  S.data.resize(size);
+  S.mask.assign(size, 0xff);
+
+  if (size == 0 || !bfd_get_section_contents(abfd, section, &S.data[0], 0, size))
+    {
+      S.data.clear();
+      S.mask.clear();
+      return;
+    }
+
+  if (!object)
+    return;
+
+  const RelocTable &relocs = E->getRelocs();
+
+  for (arelent **rel = relocs.begin(section); rel != relocs.end(section); ++rel)
+    {
+      arelent *q = *rel;
+      bfd_vma at = q->address * bfd_octets_per_byte(abfd);
+
+      if (q->howto == NULL || at >= size)
+        continue;
+
+      bfd_vma n = bfd_get_reloc_size(q->howto);
+      if (at + n > size)
+        n = size - at;
+
+      memset(&S.mask[at], 0, n);
+    }
+}
+
+FunctionDiff::FunctionDiff()
+{
+  this->exefile = nullptr;
+  this->AB = nullptr;
+}
+
+FunctionDiff::FunctionDiff(std::vector<ELFFile *> objs, ELFFile *exe, const AddressBinding *binding)
+  : objfiles(objs), exefile(exe), AB(binding)
+{
+  // bfd isn't thread safe, everything is read here
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+
+  this->loadFile(exe, false);
+  for (ELFFile *E : this->objfiles)
+    this->loadFile(E, true);
+}
+
+FunctionDiff::~FunctionDiff()
+{
+  this->exefile = nullptr;
+  this->AB = nullptr;
+  this->objfiles.clear();
+}
@@ -0,0 +1,103 @@
+#ifndef FUNCTIONDIFF_H
+#define FUNCTIONDIFF_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "elffile.h"
+#include "addressbinding.h"
+
+const int DIFF_MATCH = 0;
+const int DIFF_RELOCATED = 1;   // equal once the relocated fields are masked
+const int DIFF_MISMATCH = 2;
+const int DIFF_MISSING = 3;     // no instruction at this offset on the other side
+
+// one instruction of a function, paired with the instruction found at the
+// same offset in the other file; indexes are into Function::getCodeLines()
+// and are -1 when that side has no instruction there
+struct LineDiff
+{
+  bfd_vma offset;
+  int exeLine;
+  int objLine;
+  int status;
+};
+
+struct FunctionReport
+{
+  std::string name;
+  std::string file;
+  size_t lines;
+  size_t relocated;
+  size_t mismatches;
+  size_t missing;
+};
+
+// Compares the code of every object function against the function found at
+// its final address in the executable. Both sides are aligned by their offset from the start of
+// the function and the bytes patched by the object's relocations are left
+// out, so only what the linker wasn't supposed to change is compared.
+// Section contents are read when the diff is built, compare() and
+// compareAll() only read them and can be used from several threads.
+class FunctionDiff
+{
+public:
+  std::vector<LineDiff> compare(ELFFile *, std::string) const;
+  std::vector<FunctionReport> compareAll() const;
+
+  static std::string statusName(int);
+
+  // pairs the lines of two functions, starting at the given addresses, by
+  // their offset; a line with no partner is DIFF_MISSING and the pairs
+  // are left DIFF_MATCH for the bytes to decide
+  static std::vector<LineDiff> align(const std::vector<CodeLine *> &, bfd_vma,
+                                     const std::vector<CodeLine *> &, bfd_vma);
+
+  // where an object function starts in the executable: its offset in the
+  // section moved to where the section was placed, else where the binding
+  // put the object's own definition; (bfd_vma) -1 when neither is known
+  static bfd_vma exeAddress(asection *, bfd_vma,
+                            const std::unordered_map<asection *, bfd_vma> &, const Symbol *);
+
+  FunctionDiff();
+  FunctionDiff(std::vector<ELFFile *>, ELFFile *, const AddressBinding *);
+  virtual ~FunctionDiff();
+
+protected:
+private:
+  struct LoadedSection
+  {
+    std::vector<bfd_byte> data;
+    // 0x00 for relocated bytes, 0xff for the ones to compare
+    std::vector<unsigned char> mask;
+  };
+
+  struct Placement
+  {
+    asection *section;
+    bfd_vma vma;
+    bfd_vma size;
+    Function *function;
+    // start of the executable function it is compared to
+    bfd_vma exeVma;
+  };
+
+  typedef std::unordered_map<std::string, Placement> PlacementMap;
+
+  void loadFile(ELFFile *, bool);
+  void loadSection(ELFFile *, asection *, bool);
+
+  std::vector<ELFFile *> objfiles;
+  ELFFile *exefile;
+  const AddressBinding *AB;
+
+  std::unordered_map<asection *, LoadedSection> sections;
+  std::unordered_map<ELFFile *, PlacementMap> placements;
+  // the executable functions by their start, and the start of every name
+  // only one of them uses
+  std::unordered_map<bfd_vma, Placement> exeFunctions;
+  std::unordered_map<std::string, bfd_vma> exeNames;
+};
+
+#endif // FUNCTIONDIFF_H
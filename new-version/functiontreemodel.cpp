@@ -0,0 +1,177 @@
+#include <iterator>
+
+#include "functiontreemodel.h"
+
+// instructions carry the row of their function plus one in the internal
+// id of their index, functions carry 0
+FunctionTreeModel::FunctionTreeModel(QObject *parent)
+  : QAbstractItemModel(parent)
+{}
+
+FunctionTreeModel::~FunctionTreeModel()
+{}
+
+void FunctionTreeModel::setEntries(std::vector<Entry> newEntries)
+{
+  this->beginResetModel();
+
+  this->entries.swap(newEntries);
+  this->rows.clear();
+
+  // the first function of a name is the one found
+  for (size_t i = 0; i < this->entries.size(); ++i)
+    this->rows.emplace(this->entries[i].name, (int) i);
+
+  this->endResetModel();
+}
+
+void FunctionTreeModel::insertEntries(int row, std::vector<Entry> newEntries)
+{
+  if (newEntries.empty())
+    return;
+
+  int count = (int) newEntries.size();
+
+  if (row < 0 || row > (int) this->entries.size())
+    row = (int) this->entries.size();
+
+  this->beginInsertRows(QModelIndex(), row, row + count - 1);
+
+  this->entries.insert(this->entries.begin() + row,
+                       std::make_move_iterator(newEntries.begin()),
+                       std::make_move_iterator(newEntries.end()));
+
+  // the rows after the new ones moved down
+  for (size_t i = row + count; i < this->entries.size(); ++i)
+    {
+      auto it = this->rows.find(this->entries[i].name);
+
+      if (it != this->rows.end() && it->second == (int) i - count)
+        it->second = (int) i;
+    }
+
+  for (int i = row; i < row + count; ++i)
+    this->rows.emplace(this->entries[i].name, i);
+
+  this->endInsertRows();
+}
+
+void FunctionTreeModel::clear()
+{
+  this->setEntries(std::vector<Entry>());
+}
+
+int FunctionTreeModel::findRow(const std::string &name) const
+{
+  auto it = this->rows.find(name);
+
+  return (it == this->rows.end()) ? -1 : it->second;
+}
+
+const FunctionTreeModel::Entry &FunctionTreeModel::entry(int row) const
+{
+  return this->entries.at(row);
+}
+
+QModelIndex FunctionTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+  if (row < 0 || column < 0 || column >= this->columnCount())
+    return QModelIndex();
+
+  if (!parent.isValid())
+    {
+      if ((size_t) row >= this->entries.size())
+        return QModelIndex();
+
+      return this->createIndex(row, column, (quintptr) 0);
+    }
+
+  if (parent.internalId() != 0 || row >= this->rowCount(parent))
+    return QModelIndex();
+
+  return this->createIndex(row, column, (quintptr) parent.row() + 1);
+}
+
+QModelIndex FunctionTreeModel::parent(const QModelIndex &child) const
+{
+  if (!child.isValid() || child.internalId() == 0)
+    return QModelIndex();
+
+  return this->createIndex((int) child.internalId() - 1, 0, (quintptr) 0);
+}
+
+int FunctionTreeModel::rowCount(const QModelIndex &parent) const
+{
+  if (!parent.isValid())
+    return (int) this->entries.size();
+
+  // only functions have children, and only through their first column
+  if (parent.internalId() != 0 || parent.column() != 0)
+    return 0;
+
+  Function *f = this->entries[parent.row()].function;
+
+  return (f == nullptr) ? 0 : (int) f->getCodeLineCount();
+}
+
+int FunctionTreeModel::columnCount(const QModelIndex &) const
+{
+  return 3;
+}
+
+QVariant FunctionTreeModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+
+  if (index.internalId() == 0)
+    {
+      const Entry &E = this->entries[index.row()];
+
+      if (role == Qt::DisplayRole && index.column() == 0)
+        return QString::fromStdString(E.name);
+
+      if (role == Qt::ToolTipRole && !E.tooltip.empty())
+        return QString::fromStdString(E.tooltip);
+
+      return QVariant();
+    }
+
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  Function *f = this->entries[index.internalId() - 1].function;
+  const CodeLine *c = f->getCodeLine(index.row());
+
+  switch (index.column())
+    {
+    case 0:
+      return QString::fromStdString(c->getAddress());
+    case 1:
+      if (c->hasRelocs())
+        return QString::fromStdString(c->getLine() + "    ; " + c->getRelocText());
+      return QString::fromStdString(c->getLine());
+    case 2:
+      return QString::fromStdString(c->getHexValue());
+    default:
+      return QVariant();
+    }
+}
+
+QVariant FunctionTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+
+  switch (section)
+    {
+    case 0:
+      return QString("Offset");
+    case 1:
+      return QString("Instruction");
+    case 2:
+      return QString("Opcode");
+    default:
+      return QVariant();
+    }
+}
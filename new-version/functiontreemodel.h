@@ -0,0 +1,53 @@
+#ifndef FUNCTIONTREEMODEL_H
+#define FUNCTIONTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "function.h"
+
+// The functions of a file as a two level tree: a row per function and,
+// under it, a row per instruction. Nothing is copied out of the Function
+// and CodeLine objects, the text of a row is made when a view asks for
+// it, so only the rows on screen cost anything.
+class FunctionTreeModel : public QAbstractItemModel
+{
+  Q_OBJECT
+
+public:
+  // a top level row; functions that aren't disassembled, like the ones
+  // a library provides, have no Function and no children
+  struct Entry
+  {
+    std::string name;
+    Function *function;
+    std::string tooltip;
+  };
+
+  explicit FunctionTreeModel(QObject *parent = 0);
+  ~FunctionTreeModel();
+
+  void setEntries(std::vector<Entry>);
+  // adds rows before *row* without resetting the views
+  void insertEntries(int, std::vector<Entry>);
+  void clear();
+
+  // the row of a function, or -1
+  int findRow(const std::string &) const;
+  const Entry &entry(int) const;
+
+  QModelIndex index(int, int, const QModelIndex & = QModelIndex()) const;
+  QModelIndex parent(const QModelIndex &) const;
+  int rowCount(const QModelIndex & = QModelIndex()) const;
+  int columnCount(const QModelIndex & = QModelIndex()) const;
+  QVariant data(const QModelIndex &, int = Qt::DisplayRole) const;
+  QVariant headerData(int, Qt::Orientation, int = Qt::DisplayRole) const;
+
+private:
+  std::vector<Entry> entries;
+  std::unordered_map<std::string, int> rows;
+};
+
+#endif // FUNCTIONTREEMODEL_H
@@ -0,0 +1,143 @@
+#include <QFontDatabase>
+#include <cstdlib>
+
+#include "hexviewer.h"
+#include "ui_hexviewer.h"
+
+HexViewer::HexViewer(QWidget *parent) :
+  QWidget(parent, Qt::Window),
+  ui(new Ui::HexViewer)
+{
+  ui->setupUi(this);
+
+  this->model = new HexViewModel(this);
+
+  ui->hexList->setModel(this->model);
+  ui->hexList->setUniformItemSizes(true);
+  ui->hexList->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  connect(ui->sectionBox, SIGNAL(currentIndexChanged(int)), this, SLOT(sectionChosen(int)));
+  connect(ui->gotoEdit, SIGNAL(returnPressed()), this, SLOT(goTo()));
+}
+
+HexViewer::~HexViewer()
+{
+  // the model mustn't point into the mapping once it's gone
+  this->model->clear();
+
+  delete ui;
+}
+
+bool HexViewer::open(QString path)
+{
+  this->model->clear();
+  this->listed.clear();
+
+  ui->sectionBox->blockSignals(true);
+  ui->sectionBox->clear();
+
+  bool ok = this->file.open(path.toStdString());
+
+  if (ok)
+    {
+      const std::vector<MappedSection> &sections = this->file.getSections();
+
+      // only the sections with bytes in the file
+      for (size_t i = 0; i < sections.size(); ++i)
+        {
+          if (sections[i].nobits || sections[i].size == 0)
+            continue;
+
+          ui->sectionBox->addItem(QString::fromStdString(sections[i].name));
+          this->listed.push_back(i);
+        }
+    }
+
+  ui->sectionBox->setCurrentIndex(-1);
+  ui->sectionBox->blockSignals(false);
+
+  this->setWindowTitle(path);
+
+  // the code is what is usually looked at first
+  int text = ui->sectionBox->findText(".text");
+  ui->sectionBox->setCurrentIndex(text >= 0 ? text : 0);
+
+  return ok;
+}
+
+void HexViewer::sectionChosen(int entry)
+{
+  if (entry < 0 || (size_t) entry >= this->listed.size())
+    {
+      this->model->clear();
+      return;
+    }
+
+  size_t i = this->listed[entry];
+  const MappedSection &S = this->file.getSections()[i];
+
+  this->model->setBytes(this->file.bytes(i), S.size, S.vma);
+}
+
+// symbols first, then addresses; in a relocatable file, or when no
+// section holds the address, a number is an offset in the shown section
+void HexViewer::goTo()
+{
+  std::string text = ui->gotoEdit->text().trimmed().toStdString();
+  size_t section;
+  uint64_t offset;
+
+  if (text.empty())
+    return;
+
+  if (this->file.findSymbol(text, &section, &offset))
+    {
+      this->showAt(section, offset);
+      return;
+    }
+
+  char *end;
+  uint64_t value = strtoull(text.c_str(), &end, 16);
+
+  if (*end != '\0')
+    return;
+
+  int entry = ui->sectionBox->currentIndex();
+  const std::vector<MappedSection> &sections = this->file.getSections();
+
+  // the shown section first, addresses of several sections can overlap
+  if (entry >= 0)
+    {
+      const MappedSection &S = sections[this->listed[entry]];
+
+      if (S.vma != 0 && value >= S.vma && value - S.vma < S.size)
+        {
+          this->showAt(this->listed[entry], value - S.vma);
+          return;
+        }
+    }
+
+  if (this->file.findAddress(value, &section, &offset))
+    this->showAt(section, offset);
+  else if (entry >= 0 && value < sections[this->listed[entry]].size)
+    this->showAt(this->listed[entry], value);
+}
+
+// shows a section and selects the row of a byte in it
+void HexViewer::showAt(size_t section, uint64_t offset)
+{
+  for (size_t entry = 0; entry < this->listed.size(); ++entry)
+    {
+      if (this->listed[entry] != section)
+        continue;
+
+      if (ui->sectionBox->currentIndex() != (int) entry)
+        ui->sectionBox->setCurrentIndex(entry);
+
+      QModelIndex row = this->model->index(this->model->rowOf(offset));
+
+      ui->hexList->setCurrentIndex(row);
+      ui->hexList->scrollTo(row, QAbstractItemView::PositionAtTop);
+      return;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef HEXVIEWER_H
+#define HEXVIEWER_H
+
+#include <QWidget>
+#include <QString>
+#include <vector>
+
+#include "sectionmap.h"
+#include "hexviewmodel.h"
+
+namespace Ui {
+  class HexViewer;
+}
+
+// A window showing the bytes of any section of a file. The file is
+// mapped rather than read, so it can be of any size.
+class HexViewer : public QWidget
+{
+  Q_OBJECT
+
+public:
+  explicit HexViewer(QWidget *parent = 0);
+  ~HexViewer();
+
+  // false when the file isn't ELF
+  bool open(QString);
+
+private slots:
+  void sectionChosen(int);
+  void goTo();
+
+private:
+  void showAt(size_t, uint64_t);
+
+  Ui::HexViewer *ui;
+
+  SectionMap file;
+  HexViewModel *model;
+
+  // the section of every entry of the box
+  std::vector<size_t> listed;
+};
+
+#endif // HEXVIEWER_H
@@ -0,0 +1,71 @@
+#include <climits>
+#include <cstdio>
+
+#include "hexviewmodel.h"
+#include "bytetools.h"
+
+HexViewModel::HexViewModel(QObject *parent)
+  : QAbstractListModel(parent), bytes(NULL), size(0), vma(0)
+{}
+
+HexViewModel::~HexViewModel()
+{}
+
+void HexViewModel::setBytes(const unsigned char *data, uint64_t count, uint64_t address)
+{
+  this->beginResetModel();
+
+  this->bytes = data;
+  this->size = (data == NULL) ? 0 : count;
+  this->vma = address;
+
+  this->endResetModel();
+}
+
+void HexViewModel::clear()
+{
+  this->setBytes(NULL, 0, 0);
+}
+
+int HexViewModel::rowOf(uint64_t offset) const
+{
+  if (offset >= this->size)
+    return this->rowCount() - 1;
+
+  return (int) (offset / HEX_ROW_BYTES);
+}
+
+// views count rows with an int, what doesn't fit isn't shown
+int HexViewModel::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid())
+    return 0;
+
+  uint64_t rows = (this->size + HEX_ROW_BYTES - 1) / HEX_ROW_BYTES;
+
+  return (rows > INT_MAX) ? INT_MAX : (int) rows;
+}
+
+QVariant HexViewModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || role != Qt::DisplayRole || index.row() >= this->rowCount())
+    return QVariant();
+
+  uint64_t offset = (uint64_t) index.row() * HEX_ROW_BYTES;
+  size_t count = (this->size - offset < HEX_ROW_BYTES) ? this->size - offset : HEX_ROW_BYTES;
+  const unsigned char *in = this->bytes + offset;
+
+  // address, the "xx " groups padded to a full row, then the ASCII
+  char line[32 + 3 * HEX_ROW_BYTES + HEX_ROW_BYTES];
+  int len = snprintf(line, 32, "%08llx  ", (unsigned long long) (this->vma + offset));
+  char *out = ByteTools::hex_encode<1, false>(in, count, line + len);
+
+  for (size_t i = count; i < HEX_ROW_BYTES; ++i, out += 3)
+    memcpy(out, "   ", 3);
+
+  *out++ = ' ';
+  for (size_t i = 0; i < count; ++i)
+    *out++ = (in[i] >= 0x20 && in[i] < 0x7f) ? in[i] : '.';
+
+  return QString::fromLatin1(line, out - line);
+}
@@ -0,0 +1,38 @@
+#ifndef HEXVIEWMODEL_H
+#define HEXVIEWMODEL_H
+
+#include <QAbstractListModel>
+#include <cstdint>
+
+// bytes shown on a row
+const int HEX_ROW_BYTES = 16;
+
+// A run of bytes as rows of address, hex and ASCII. The bytes aren't
+// copied, a row is encoded when a view asks for it, so only the rows on
+// screen are ever read from the mapping.
+class HexViewModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  explicit HexViewModel(QObject *parent = 0);
+  ~HexViewModel();
+
+  // *data* must stay mapped while it's shown, *vma* is the address of
+  // the first byte
+  void setBytes(const unsigned char *, uint64_t, uint64_t);
+  void clear();
+
+  // the row showing a byte
+  int rowOf(uint64_t) const;
+
+  int rowCount(const QModelIndex & = QModelIndex()) const;
+  QVariant data(const QModelIndex &, int = Qt::DisplayRole) const;
+
+private:
+  const unsigned char *bytes;
+  uint64_t size;
+  uint64_t vma;
+};
+
+#endif // HEXVIEWMODEL_H
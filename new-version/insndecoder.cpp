@@ -0,0 +1,572 @@
+#include "insndecoder.h"
+
+namespace InsnDecoder
+{
+  // x86 opcode properties
+  static const unsigned short X_M = 0x001;     // has a ModRM byte
+  static const unsigned short X_I8 = 0x002;    // 8-bit immediate
+  static const unsigned short X_IZ = 0x004;    // 16 or 32-bit immediate
+  static const unsigned short X_IW = 0x008;    // 16-bit immediate
+  static const unsigned short X_IV = 0x010;    // 16, 32 or 64-bit immediate
+  static const unsigned short X_MO = 0x020;    // memory offset
+  static const unsigned short X_P = 0x040;     // legacy prefix
+  static const unsigned short X_G3 = 0x080;    // immediate only for /0 and /1
+  static const unsigned short X_FAR = 0x100;   // far pointer
+  static const unsigned short X_ENT = 0x200;   // enter, 16 + 8-bit immediate
+  static const unsigned short X_NO64 = 0x400;  // invalid in 64-bit mode
+  static const unsigned short X_BAD = 0x800;   // invalid
+
+  // one byte opcode map
+  static const unsigned short x86_map0[256] =
+  {
+    /* 00 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_NO64, X_NO64,
+    /* 08 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_NO64, 0,
+    /* 10 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_NO64, X_NO64,
+    /* 18 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_NO64, X_NO64,
+    /* 20 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_P, X_NO64,
+    /* 28 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_P, X_NO64,
+    /* 30 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_P, X_NO64,
+    /* 38 */ X_M, X_M, X_M, X_M, X_I8, X_IZ, X_P, X_NO64,
+    /* 40 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 48 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 50 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 58 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 60 */ X_NO64, X_NO64, X_M | X_NO64, X_M, X_P, X_P, X_P, X_P,
+    /* 68 */ X_IZ, X_M | X_IZ, X_I8, X_M | X_I8, 0, 0, 0, 0,
+    /* 70 */ X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8,
+    /* 78 */ X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8,
+    /* 80 */ X_M | X_I8, X_M | X_IZ, X_M | X_I8 | X_NO64, X_M | X_I8, X_M, X_M, X_M, X_M,
+    /* 88 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 90 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 98 */ 0, 0, X_FAR | X_NO64, 0, 0, 0, 0, 0,
+    /* a0 */ X_MO, X_MO, X_MO, X_MO, 0, 0, 0, 0,
+    /* a8 */ X_I8, X_IZ, 0, 0, 0, 0, 0, 0,
+    /* b0 */ X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8,
+    /* b8 */ X_IV, X_IV, X_IV, X_IV, X_IV, X_IV, X_IV, X_IV,
+    /* c0 */ X_M | X_I8, X_M | X_I8, X_IW, 0, X_M | X_NO64, X_M | X_NO64, X_M | X_I8, X_M | X_IZ,
+    /* c8 */ X_ENT, 0, X_IW, 0, 0, X_I8, X_NO64, 0,
+    /* d0 */ X_M, X_M, X_M, X_M, X_I8 | X_NO64, X_I8 | X_NO64, X_BAD, 0,
+    /* d8 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* e0 */ X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8, X_I8,
+    /* e8 */ X_IZ, X_IZ, X_FAR | X_NO64, X_I8, 0, 0, 0, 0,
+    /* f0 */ X_P, 0, X_P, X_P, 0, 0, X_M | X_G3, X_M | X_G3,
+    /* f8 */ 0, 0, 0, 0, 0, 0, X_M, X_M
+  };
+
+  // two byte (0f xx) opcode map
+  static const unsigned short x86_map1[256] =
+  {
+    /* 00 */ X_M, X_M, X_M, X_M, X_BAD, 0, 0, 0,
+    /* 08 */ 0, 0, X_BAD, 0, X_BAD, X_M, 0, X_M | X_I8,
+    /* 10 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 18 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 20 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 28 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 30 */ 0, 0, 0, 0, 0, 0, X_BAD, 0,
+    /* 38 */ 0, X_BAD, 0, X_BAD, X_BAD, X_BAD, X_BAD, X_BAD,
+    /* 40 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 48 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 50 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 58 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 60 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 68 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 70 */ X_M | X_I8, X_M | X_I8, X_M | X_I8, X_M | X_I8, X_M, X_M, X_M, 0,
+    /* 78 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 80 */ X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ,
+    /* 88 */ X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ, X_IZ,
+    /* 90 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* 98 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* a0 */ 0, 0, 0, X_M, X_M | X_I8, X_M, X_BAD, X_BAD,
+    /* a8 */ 0, 0, 0, X_M, X_M | X_I8, X_M, X_M, X_M,
+    /* b0 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* b8 */ X_M, X_M, X_M | X_I8, X_M, X_M, X_M, X_M, X_M,
+    /* c0 */ X_M, X_M, X_M | X_I8, X_M, X_M | X_I8, X_M | X_I8, X_M | X_I8, X_M,
+    /* c8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* d0 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* d8 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* e0 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* e8 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* f0 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M,
+    /* f8 */ X_M, X_M, X_M, X_M, X_M, X_M, X_M, X_M
+  };
+
+  static inline bfd_vma sign_extend(bfd_vma value, int bits)
+  {
+    bfd_vma sign = (bfd_vma) 1 << (bits - 1);
+
+    value &= (sign << 1) - 1;
+
+    return (value ^ sign) - sign;
+  }
+
+  static inline bfd_vma read_le(const bfd_byte *p, int size)
+  {
+    bfd_vma value = 0;
+
+    for (int k = size - 1; k >= 0; --k)
+      value = (value << 8) | p[k];
+
+    return value;
+  }
+
+  int decode_x86(const bfd_byte *p, size_t size, bfd_vma vma, bool mode64, Insn *insn)
+  {
+    size_t max = size < 15 ? size : 15;
+    size_t i = 0;
+    bool opsize16 = false;
+    bool adsize = false;
+    bool rexw = false;
+    bool p66 = false;
+    bool pf2 = false;
+    bool vex = false;
+    int map = 0;
+    unsigned short flags;
+    int disp = 0;
+    int imm = 0;
+    unsigned char op;
+
+    insn->vma = vma;
+    insn->target = 0;
+    insn->disp = 0;
+    insn->kind = INSN_PLAIN;
+    insn->flags = 0;
+
+    // legacy prefixes, a REX prefix only counts right before the opcode
+    for (;;)
+      {
+        if (i >= max)
+          return 0;
+
+        op = p[i];
+
+        if (x86_map0[op] & X_P)
+          {
+            if (op == 0x66)
+              opsize16 = p66 = true;
+            else if (op == 0x67)
+              adsize = true;
+            else if (op == 0xf2)
+              pf2 = true;
+
+            rexw = false;
+            ++i;
+          }
+        else if (mode64 && (op & 0xf0) == 0x40)
+          {
+            rexw = (op & 0x08) != 0;
+            ++i;
+          }
+        else
+          break;
+      }
+
+    ++i;
+
+    if (op == 0x0f)
+      {
+        if (i >= max)
+          return 0;
+
+        op = p[i++];
+        map = 1;
+
+        if (op == 0x38 || op == 0x3a)
+          {
+            if (i >= max)
+              return 0;
+
+            map = (op == 0x38) ? 2 : 3;
+            op = p[i++];
+          }
+      }
+    else if ((op == 0xc4 || op == 0xc5 || op == 0x62) && i < max
+             && (mode64 || (p[i] & 0xc0) == 0xc0))
+      {
+        // VEX and EVEX, the 32-bit mode LES/LDS/BOUND forms can't use
+        // a register operand
+        int payload = (op == 0xc5) ? 1 : (op == 0xc4) ? 2 : 3;
+
+        if (i + payload >= max)
+          return 0;
+
+        if (op == 0xc5)
+          map = 1;
+        else if (op == 0xc4)
+          map = p[i] & 0x1f;
+        else
+          map = p[i] & 0x07;
+
+        vex = true;
+        i += payload;
+        op = p[i++];
+      }
+    else if (op == 0x8f && i < max && (p[i] & 0x1f) >= 8)
+      {
+        // AMD XOP, told apart from pop by a non-zero ModRM reg field
+        if (i + 2 >= max)
+          return 0;
+
+        map = p[i] & 0x1f;
+        vex = true;
+        i += 2;
+        op = p[i++];
+      }
+
+    switch (map)
+      {
+      case 0:
+        flags = x86_map0[op];
+        if (mode64 && (flags & X_NO64))
+          return 0;
+        break;
+      case 1:
+        flags = x86_map1[op];
+        if (vex)
+          flags = (op == 0x77) ? 0 : (flags & X_I8) | X_M;
+        else if (op == 0x78 && (p66 || pf2))
+          flags = X_M | X_IW;       // extrq / insertq carry two imm8
+        break;
+      case 3:
+      case 8:
+        flags = X_M | X_I8;
+        break;
+      case 10:
+        flags = X_M | X_IZ;
+        opsize16 = false;
+        break;
+      default:
+        flags = X_M;
+        break;
+      }
+
+    if (flags & X_BAD)
+      return 0;
+
+    if (flags & X_M)
+      {
+        if (i >= max)
+          return 0;
+
+        unsigned char modrm = p[i++];
+        int mod = modrm >> 6;
+        int rm = modrm & 7;
+        int reg = (modrm >> 3) & 7;
+
+        if (mod != 3)
+          {
+            if (!mode64 && adsize)
+              {
+                if ((mod == 0 && rm == 6) || mod == 2)
+                  disp = 2;
+                else if (mod == 1)
+                  disp = 1;
+              }
+            else
+              {
+                if (rm == 4)
+                  {
+                    if (i >= max)
+                      return 0;
+
+                    if ((p[i++] & 7) == 5 && mod == 0)
+                      disp = 4;
+                  }
+
+                if ((mod == 0 && rm == 5) || mod == 2)
+                  disp = 4;
+                else if (mod == 1)
+                  disp = 1;
+
+                if (mode64 && mod == 0 && rm == 5)
+                  insn->flags |= INSN_RIPREL;
+              }
+          }
+
+        if ((flags & X_G3) && reg < 2)
+          flags |= (op == 0xf6) ? X_I8 : X_IZ;
+
+        if (map == 0 && op == 0xff)
+          {
+            if (reg == 2 || reg == 3)
+              insn->kind = INSN_INDIRECT_CALL;
+            else if (reg == 4 || reg == 5)
+              insn->kind = INSN_INDIRECT_JUMP;
+          }
+      }
+
+    if (rexw)
+      opsize16 = false;
+
+    if (flags & X_I8)
+      imm = 1;
+    else if (flags & (X_IW | X_ENT))
+      imm = (flags & X_ENT) ? 3 : 2;
+    else if (flags & X_IZ)
+      {
+        // relative branches ignore the operand size prefix in 64-bit mode
+        bool rel = (map == 0 && (op == 0xe8 || op == 0xe9))
+            || (map == 1 && !vex && (op & 0xf0) == 0x80);
+
+        imm = (opsize16 && !(mode64 && rel)) ? 2 : 4;
+      }
+    else if (flags & X_IV)
+      imm = rexw ? 8 : opsize16 ? 2 : 4;
+    else if (flags & X_MO)
+      imm = mode64 ? (adsize ? 4 : 8) : (adsize ? 2 : 4);
+    else if (flags & X_FAR)
+      imm = opsize16 ? 4 : 6;
+
+    if (i + disp + imm > max)
+      return 0;
+
+    int length = i + disp + imm;
+    const bfd_byte *immp = p + i + disp;
+
+    if (map == 0)
+      {
+        if ((op >= 0x70 && op <= 0x7f) || (op >= 0xe0 && op <= 0xe3))
+          insn->kind = INSN_COND_JUMP;
+        else if (op == 0xeb || op == 0xe9)
+          insn->kind = INSN_JUMP;
+        else if (op == 0xe8)
+          insn->kind = INSN_CALL;
+        else if (op == 0xc2 || op == 0xc3 || op == 0xca || op == 0xcb || op == 0xcf)
+          insn->kind = INSN_RETURN;
+      }
+    else if (map == 1 && !vex && (op & 0xf0) == 0x80)
+      insn->kind = INSN_COND_JUMP;
+
+    // rip-relative operands are relative to the end of the instruction
+    if (insn->flags & INSN_RIPREL)
+      {
+        insn->disp = sign_extend(read_le(p + i, 4), 32);
+        insn->target = vma + length + insn->disp;
+      }
+
+    if (insn->kind == INSN_JUMP || insn->kind == INSN_COND_JUMP || insn->kind == INSN_CALL)
+      {
+        insn->target = vma + length + sign_extend(read_le(immp, imm), imm * 8);
+
+        if (!mode64)
+          insn->target &= (imm == 2) ? 0xffff : 0xffffffff;
+      }
+
+    insn->length = length;
+
+    return length;
+  }
+
+  int decode_aarch64(const bfd_byte *p, size_t size, bfd_vma vma, Insn *insn)
+  {
+    if (size < 4)
+      return 0;
+
+    // instructions are little-endian even on big-endian targets
+    unsigned long op = read_le(p, 4);
+
+    insn->vma = vma;
+    insn->target = 0;
+    insn->disp = 0;
+    insn->length = 4;
+    insn->kind = INSN_PLAIN;
+    insn->flags = 0;
+
+    if ((op & 0x7c000000) == 0x14000000)
+      {
+        // b / bl
+        insn->kind = (op & 0x80000000) ? INSN_CALL : INSN_JUMP;
+        insn->target = vma + (sign_extend(op, 26) << 2);
+      }
+    else if ((op & 0xff000010) == 0x54000000 || (op & 0x7e000000) == 0x34000000)
+      {
+        // b.cond / cbz / cbnz
+        insn->kind = INSN_COND_JUMP;
+        insn->target = vma + (sign_extend(op >> 5, 19) << 2);
+      }
+    else if ((op & 0x7e000000) == 0x36000000)
+      {
+        // tbz / tbnz
+        insn->kind = INSN_COND_JUMP;
+        insn->target = vma + (sign_extend(op >> 5, 14) << 2);
+      }
+    else if ((op & 0xfffffc1f) == 0xd65f0000)
+      insn->kind = INSN_RETURN;
+    else if ((op & 0xfffffc1f) == 0xd61f0000)
+      insn->kind = INSN_INDIRECT_JUMP;
+    else if ((op & 0xfffffc1f) == 0xd63f0000)
+      insn->kind = INSN_INDIRECT_CALL;
+
+    return 4;
+  }
+
+  int decode_riscv(const bfd_byte *p, size_t size, bfd_vma vma, bool rv64, Insn *insn)
+  {
+    int length;
+
+    if (size < 2)
+      return 0;
+
+    if ((p[0] & 0x03) != 0x03)
+      length = 2;
+    else if ((p[0] & 0x1c) != 0x1c)
+      length = 4;
+    else if ((p[0] & 0x3f) == 0x1f)
+      length = 6;
+    else if ((p[0] & 0x7f) == 0x3f)
+      length = 8;
+    else
+      return 0;
+
+    if ((size_t) length > size)
+      return 0;
+
+    insn->vma = vma;
+    insn->target = 0;
+    insn->disp = 0;
+    insn->length = length;
+    insn->kind = INSN_PLAIN;
+    insn->flags = 0;
+
+    if (length == 2)
+      {
+        unsigned long op = read_le(p, 2);
+        unsigned long funct3 = op >> 13;
+
+        if ((op & 3) == 1 && (funct3 == 5 || (funct3 == 1 && !rv64)))
+          {
+            // c.j / c.jal
+            bfd_vma imm = ((op >> 1) & 0x800) | ((op << 2) & 0x400)
+                | ((op >> 1) & 0x300) | ((op << 1) & 0x80)
+                | ((op >> 1) & 0x40) | ((op << 3) & 0x20)
+                | ((op >> 7) & 0x10) | ((op >> 2) & 0x0e);
+
+            insn->kind = (funct3 == 5) ? INSN_JUMP : INSN_CALL;
+            insn->target = vma + sign_extend(imm, 12);
+          }
+        else if ((op & 3) == 1 && funct3 >= 6)
+          {
+            // c.beqz / c.bnez
+            bfd_vma imm = ((op >> 4) & 0x100) | ((op << 1) & 0xc0)
+                | ((op << 3) & 0x20) | ((op >> 7) & 0x18) | ((op >> 2) & 0x06);
+
+            insn->kind = INSN_COND_JUMP;
+            insn->target = vma + sign_extend(imm, 9);
+          }
+        else if ((op & 0xe07f) == 0x8002 && (op & 0x0f80) != 0)
+          {
+            // c.jr / c.jalr
+            if (op & 0x1000)
+              insn->kind = INSN_INDIRECT_CALL;
+            else
+              insn->kind = ((op & 0x0f80) == 0x0080) ? INSN_RETURN : INSN_INDIRECT_JUMP;
+          }
+
+        return length;
+      }
+
+    if (length != 4)
+      return length;
+
+    unsigned long op = read_le(p, 4);
+    unsigned long rd = (op >> 7) & 0x1f;
+    unsigned long rs1 = (op >> 15) & 0x1f;
+
+    switch (op & 0x7f)
+      {
+      case 0x6f:
+        {
+          // jal
+          bfd_vma imm = ((op >> 11) & 0x100000) | (op & 0xff000)
+              | ((op >> 9) & 0x800) | ((op >> 20) & 0x7fe);
+
+          insn->kind = (rd == 1 || rd == 5) ? INSN_CALL : INSN_JUMP;
+          insn->target = vma + sign_extend(imm, 21);
+          break;
+        }
+      case 0x63:
+        {
+          // beq, bne, blt, bge, bltu, bgeu
+          bfd_vma imm = ((op >> 19) & 0x1000) | ((op << 4) & 0x800)
+              | ((op >> 20) & 0x7e0) | ((op >> 7) & 0x1e);
+
+          insn->kind = INSN_COND_JUMP;
+          insn->target = vma + sign_extend(imm, 13);
+          break;
+        }
+      case 0x67:
+        // jalr
+        if (rd == 1 || rd == 5)
+          insn->kind = INSN_INDIRECT_CALL;
+        else if (rd == 0 && rs1 == 1 && (op >> 20) == 0)
+          insn->kind = INSN_RETURN;
+        else
+          insn->kind = INSN_INDIRECT_JUMP;
+        break;
+      default:
+        break;
+      }
+
+    return length;
+  }
+
+  bool supported(bfd *abfd)
+  {
+    switch (bfd_get_arch(abfd))
+      {
+      case bfd_arch_i386:
+      case bfd_arch_aarch64:
+      case bfd_arch_riscv:
+        return true;
+      default:
+        return false;
+      }
+  }
+
+  int decode(bfd *abfd, const bfd_byte *data, size_t size, bfd_vma vma, Insn *insn)
+  {
+    unsigned long mach = bfd_get_mach(abfd);
+
+    switch (bfd_get_arch(abfd))
+      {
+      case bfd_arch_i386:
+        return decode_x86(data, size, vma, (mach & (bfd_mach_x86_64 | bfd_mach_x64_32)) != 0, insn);
+      case bfd_arch_aarch64:
+        return decode_aarch64(data, size, vma, insn);
+      case bfd_arch_riscv:
+        return decode_riscv(data, size, vma, mach == bfd_mach_riscv64, insn);
+      default:
+        return 0;
+      }
+  }
+
+  void scan(bfd *abfd, const bfd_byte *data, size_t size, bfd_vma vma, std::vector<Insn> &out)
+  {
+    size_t offset = 0;
+    Insn insn;
+
+    if (!supported(abfd))
+      return;
+
+    // a rough guess of 4 bytes per instruction saves most reallocations
+    out.reserve(out.size() + size / 4);
+
+    while (offset < size)
+      {
+        int length = decode(abfd, data + offset, size - offset, vma + offset, &insn);
+
+        if (length == 0)
+          {
+            insn.vma = vma + offset;
+            insn.target = 0;
+            insn.disp = 0;
+            insn.length = 1;
+            insn.kind = INSN_INVALID;
+            insn.flags = 0;
+            length = 1;
+          }
+
+        out.push_back(insn);
+        offset += length;
+      }
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef INSNDECODER_H
+#define INSNDECODER_H
+
+#include <vector>
+#include <cstddef>
+
+// this needs to be defined before any bfd.h include
+// due to a 'won't fix' bug
+#define PACKAGE "elfdetective"
+
+#include <bfd.h>
+
+const int INSN_PLAIN = 0;
+const int INSN_JUMP = 1;
+const int INSN_COND_JUMP = 2;
+const int INSN_CALL = 3;
+const int INSN_RETURN = 4;
+const int INSN_INDIRECT_JUMP = 5;
+const int INSN_INDIRECT_CALL = 6;
+const int INSN_INVALID = 7;
+
+// instruction flags
+const int INSN_RIPREL = 0x01;
+
+// Fast instruction boundary decoder. It only finds out how long every
+// instruction is and where direct branches go, without building any text,
+// so it can walk whole sections at memory speed. libopcodes is still the
+// one that formats the lines that are shown.
+namespace InsnDecoder
+{
+  struct Insn
+  {
+    bfd_vma vma;
+    bfd_vma target;         // direct branch target or rip-relative address
+    bfd_signed_vma disp;    // rip-relative displacement
+    unsigned char length;
+    unsigned char kind;
+    unsigned char flags;
+  };
+
+  // decodes the x86 instruction at *data*, in 64-bit mode if *mode64* is set
+  // returns the instruction length or 0 if it can't be decoded
+  int decode_x86(const bfd_byte *, size_t, bfd_vma, bool, Insn *);
+  int decode_aarch64(const bfd_byte *, size_t, bfd_vma, Insn *);
+  int decode_riscv(const bfd_byte *, size_t, bfd_vma, bool, Insn *);
+
+  // true if there is a decoder for the file's architecture
+  bool supported(bfd *);
+
+  // decodes the single instruction at *data* with the file's decoder
+  int decode(bfd *, const bfd_byte *, size_t, bfd_vma, Insn *);
+
+  // decodes *size* bytes of code starting at *vma*; undecodable bytes are
+  // reported as one byte INSN_INVALID entries so the scan always resyncs
+  void scan(bfd *, const bfd_byte *, size_t, bfd_vma, std::vector<Insn> &);
+}
+
+#endif // INSNDECODER_H
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cstdlib>
+
+#include "layoutindex.h"
+
+LayoutIndex::LayoutIndex()
+  : start(0), end(0), maxHeat(0)
+{}
+
+LayoutIndex::~LayoutIndex()
+{}
+
+void LayoutIndex::build(const AddressBinding &AB)
+{
+  std::unordered_map<std::string, int> ownerIndex;
+
+  this->blocks.clear();
+  this->owners.clear();
+  this->maxHeat = 0;
+
+  for (const std::string &S : AB.getSymbols())
+    {
+      Symbol sym = AB.getSymbol(S);
+
+      if (!sym.isFunction() || sym.isUndefined() || !sym.placed || sym.sz == 0)
+        continue;
+
+      LayoutBlock B;
+      B.vma = sym.exe_vma;
+      B.size = sym.sz;
+      B.owner = -1;
+      B.heat = 0;
+      B.name = sym.name;
+
+      if (!sym.defined_in.empty())
+        {
+          auto it = ownerIndex.emplace(sym.defined_in, (int) this->owners.size());
+          if (it.second)
+            this->owners.push_back(sym.defined_in);
+
+          B.owner = it.first->second;
+        }
+
+      this->blocks.push_back(B);
+    }
+
+  std::sort(this->blocks.begin(), this->blocks.end(),
+            [](const LayoutBlock &A, const LayoutBlock &B)
+            {return A.vma < B.vma || (A.vma == B.vma && A.size > B.size);});
+
+  // aliases and functions inside others are dropped, so the blocks don't
+  // overlap and their ends are sorted too
+  size_t kept = 0;
+
+  for (size_t i = 0; i < this->blocks.size(); ++i)
+    {
+      if (kept > 0 && this->blocks[i].vma < this->blocks[kept - 1].vma + this->blocks[kept - 1].size)
+        continue;
+
+      this->blocks[kept++] = this->blocks[i];
+    }
+
+  this->blocks.resize(kept);
+
+  this->start = this->blocks.empty() ? 0 : this->blocks.front().vma;
+  this->end = this->blocks.empty() ? 0 : this->blocks.back().vma + this->blocks.back().size;
+}
+
+bool LayoutIndex::loadHotness(const std::string &path)
+{
+  std::ifstream in(path);
+  if (!in)
+    return false;
+
+  std::unordered_map<std::string, size_t> byName;
+  for (size_t i = 0; i < this->blocks.size(); ++i)
+    byName.emplace(this->blocks[i].name, i);
+
+  std::string line;
+
+  while (std::getline(in, line))
+    {
+      std::istringstream words(line);
+      std::string word, last;
+      double weight = 0;
+      bool found = false;
+
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      while (words >> word)
+        {
+          char *stop;
+          double value = strtod(word.c_str(), &stop);
+
+          // a trailing % is allowed, like perf prints them
+          if (!found && stop != word.c_str() && (*stop == '\0' || (*stop == '%' && stop[1] == '\0')))
+            {
+              weight = value;
+              found = true;
+            }
+
+          last = word;
+        }
+
+      auto it = byName.find(last);
+      if (!found || it == byName.end())
+        continue;
+
+      LayoutBlock &B = this->blocks[it->second];
+      B.heat += weight;
+      this->maxHeat = std::max(this->maxHeat, B.heat);
+    }
+
+  return true;
+}
+
+const std::vector<LayoutBlock> &LayoutIndex::getBlocks() const
+{
+  return this->blocks;
+}
+
+const std::vector<std::string> &LayoutIndex::getOwners() const
+{
+  return this->owners;
+}
+
+uint64_t LayoutIndex::getStart() const
+{
+  return this->start;
+}
+
+uint64_t LayoutIndex::getEnd() const
+{
+  return this->end;
+}
+
+double LayoutIndex::getMaxHeat() const
+{
+  return this->maxHeat;
+}
+
+size_t LayoutIndex::firstAfter(uint64_t vma) const
+{
+  auto it = std::upper_bound(this->blocks.begin(), this->blocks.end(), vma,
+                             [](uint64_t V, const LayoutBlock &B) {return V < B.vma + B.size;});
+
+  return it - this->blocks.begin();
+}
+
+const LayoutBlock *LayoutIndex::blockAt(uint64_t vma) const
+{
+  size_t i = this->firstAfter(vma);
+
+  if (i < this->blocks.size() && this->blocks[i].vma <= vma)
+    return &this->blocks[i];
+
+  return NULL;
+}
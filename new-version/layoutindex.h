@@ -0,0 +1,64 @@
+#ifndef LAYOUTINDEX_H
+#define LAYOUTINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "addressbinding.h"
+
+// a function placed in the executable
+struct LayoutBlock
+{
+  uint64_t vma;
+  uint64_t size;
+
+  // index in getOwners(), -1 when no object defines it
+  int owner;
+
+  // weight read from a profile, 0 when it has none
+  double heat;
+
+  std::string name;
+};
+
+// The functions of the executable sorted by address, for drawing its
+// layout. It's built once and only read afterwards, so the tile renderers
+// share it between threads.
+class LayoutIndex
+{
+public:
+  void build(const AddressBinding &);
+
+  // reads "weight symbol" lines; the weight is the first number of the
+  // line and the symbol its last word, which also takes the lines of
+  // perf report --stdio
+  bool loadHotness(const std::string &);
+
+  const std::vector<LayoutBlock> &getBlocks() const;
+  const std::vector<std::string> &getOwners() const;
+
+  uint64_t getStart() const;
+  uint64_t getEnd() const;
+  double getMaxHeat() const;
+
+  // the first block ending after an address, or the block count
+  size_t firstAfter(uint64_t) const;
+  // the block holding an address, or NULL
+  const LayoutBlock *blockAt(uint64_t) const;
+
+  LayoutIndex();
+  virtual ~LayoutIndex();
+
+protected:
+private:
+  std::vector<LayoutBlock> blocks;
+  std::vector<std::string> owners;
+
+  uint64_t start;
+  uint64_t end;
+  double maxHeat;
+};
+
+#endif // LAYOUTINDEX_H
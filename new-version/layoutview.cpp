@@ -0,0 +1,386 @@
+#include <QPainter>
+#include <QScrollBar>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QRunnable>
+#include <QColor>
+#include <climits>
+#include <cmath>
+
+#include "layoutview.h"
+
+const int MIN_ZOOM = -3;
+const int MAX_ZOOM = 30;
+
+// tiles kept around, 256 KiB each
+const int MAX_TILES = 256;
+
+namespace
+{
+  // renders a tile away from the GUI thread and hands it back
+  class TileJob : public QRunnable
+  {
+  public:
+    TileJob(LayoutView *v, std::shared_ptr<const LayoutIndex> i, int o, double b, int x, int y, int g)
+      : view(v), index(i), overlay(o), bpp(b), tx(x), ty(y), generation(g)
+    {}
+
+    void run()
+    {
+      QImage image = LayoutView::renderTile(*this->index, this->overlay, this->bpp, this->tx, this->ty);
+      qint64 key = (qint64) this->ty * LAYOUT_COLUMNS + this->tx;
+
+      QMetaObject::invokeMethod(this->view, "tileReady", Qt::QueuedConnection,
+                                Q_ARG(int, this->generation), Q_ARG(qint64, key),
+                                Q_ARG(QImage, image));
+    }
+
+  private:
+    LayoutView *view;
+    std::shared_ptr<const LayoutIndex> index;
+    int overlay;
+    double bpp;
+    int tx;
+    int ty;
+    int generation;
+  };
+
+  QRgb blockColor(const LayoutIndex &I, size_t i, int overlay)
+  {
+    const LayoutBlock &B = I.getBlocks()[i];
+
+    if (overlay == LAYOUT_OBJECTS)
+      {
+        if (B.owner < 0)
+          return qRgb(128, 128, 128);
+
+        // golden ratio steps keep the hues of nearby indexes apart
+        double hue = std::fmod(B.owner * 0.618033988749895, 1.0);
+        return QColor::fromHsvF(hue, 0.65, 0.95).rgb();
+      }
+
+    if (overlay == LAYOUT_HEAT)
+      {
+        if (B.heat <= 0 || I.getMaxHeat() <= 0)
+          return qRgb(40, 50, 90);
+
+        // log scale, a few hot functions shouldn't hide the warm ones
+        double t = std::log1p(B.heat) / std::log1p(I.getMaxHeat());
+        return QColor::fromHsvF((1.0 - t) * 0.66, 0.9, 0.6 + 0.4 * t).rgb();
+      }
+
+    return (i & 1) ? qRgb(74, 144, 217) : qRgb(47, 111, 176);
+  }
+}
+
+LayoutView::LayoutView(QWidget *parent)
+  : QAbstractScrollArea(parent), overlay(LAYOUT_FUNCTIONS), zoomLevel(0), generation(0)
+{
+  this->setWindowFlags(Qt::Window);
+  this->resize(LAYOUT_TILE * LAYOUT_COLUMNS + 20, 600);
+  this->viewport()->setMouseTracking(true);
+  this->updateTitle();
+}
+
+LayoutView::~LayoutView()
+{
+  // the jobs point at the view
+  this->pool.clear();
+  this->pool.waitForDone();
+}
+
+void LayoutView::setIndex(std::shared_ptr<const LayoutIndex> I)
+{
+  this->index = I;
+
+  // the whole executable fits the window at first
+  this->zoomLevel = MIN_ZOOM;
+  if (I && I->getEnd() > I->getStart())
+    {
+      double fit = (double) (I->getEnd() - I->getStart())
+                   / ((double) LAYOUT_TILE * LAYOUT_COLUMNS * std::max(1, this->viewport()->height()));
+
+      while (this->zoomLevel < MAX_ZOOM && std::ldexp(1.0, this->zoomLevel) < fit)
+        ++this->zoomLevel;
+    }
+
+  this->reset();
+  this->verticalScrollBar()->setValue(0);
+}
+
+void LayoutView::setOverlay(int mode)
+{
+  if (mode == this->overlay)
+    return;
+
+  this->overlay = mode;
+  this->reset();
+}
+
+QImage LayoutView::renderTile(const LayoutIndex &I, int overlay, double bpp, int tx, int ty)
+{
+  QImage image(LAYOUT_TILE, LAYOUT_TILE, QImage::Format_RGB32);
+  const std::vector<LayoutBlock> &blocks = I.getBlocks();
+  const double rowBytes = bpp * LAYOUT_TILE * LAYOUT_COLUMNS;
+  const QRgb gap = qRgb(32, 32, 32);
+  const QRgb outside = qRgb(0, 0, 0);
+
+  for (int y = 0; y < LAYOUT_TILE; ++y)
+    {
+      QRgb *line = (QRgb *) image.scanLine(y);
+      double rowStart = I.getStart() + (double) (ty * LAYOUT_TILE + y) * rowBytes
+                        + (double) tx * LAYOUT_TILE * bpp;
+      size_t b = I.firstAfter((uint64_t) rowStart);
+
+      // the pixels of a row are in address order, the blocks are walked
+      // along with them
+      for (int x = 0; x < LAYOUT_TILE; ++x)
+        {
+          double from = rowStart + x * bpp;
+          double to = from + bpp;
+
+          if (from >= I.getEnd())
+            {
+              line[x] = outside;
+              continue;
+            }
+
+          while (b < blocks.size() && blocks[b].vma + blocks[b].size <= from)
+            ++b;
+
+          if (b < blocks.size() && (double) blocks[b].vma < to)
+            line[x] = blockColor(I, b, overlay);
+          else
+            line[x] = gap;
+        }
+    }
+
+  return image;
+}
+
+double LayoutView::bytesPerPixel() const
+{
+  return std::ldexp(1.0, this->zoomLevel);
+}
+
+// rows of pixels needed for the whole executable at this zoom
+int LayoutView::mapHeight() const
+{
+  if (!this->index)
+    return 0;
+
+  double rows = std::ceil((double) (this->index->getEnd() - this->index->getStart())
+                          / (this->bytesPerPixel() * LAYOUT_TILE * LAYOUT_COLUMNS));
+
+  return (int) std::min(rows, (double) INT_MAX / 2);
+}
+
+uint64_t LayoutView::addressAt(QPoint p) const
+{
+  if (!this->index)
+    return 0;
+
+  double x = p.x() + this->horizontalScrollBar()->value();
+  double y = p.y() + this->verticalScrollBar()->value();
+
+  return this->index->getStart()
+         + (uint64_t) ((y * LAYOUT_TILE * LAYOUT_COLUMNS + x) * this->bytesPerPixel());
+}
+
+// changes the zoom keeping the address under *at* where it is
+void LayoutView::zoom(int steps, QPoint at)
+{
+  int level = std::max(MIN_ZOOM, std::min(MAX_ZOOM, this->zoomLevel - steps));
+
+  if (level == this->zoomLevel || !this->index)
+    return;
+
+  uint64_t vma = this->addressAt(at);
+
+  this->zoomLevel = level;
+  this->reset();
+
+  double pixel = (double) (vma - this->index->getStart()) / this->bytesPerPixel();
+  int row = (int) (pixel / (LAYOUT_TILE * LAYOUT_COLUMNS));
+
+  this->verticalScrollBar()->setValue(row - at.y());
+}
+
+// drops every tile, they are drawn again as they are needed
+void LayoutView::reset()
+{
+  this->pool.clear();
+  this->generation++;
+  this->tiles.clear();
+  this->pending.clear();
+
+  this->updateScrollBars();
+  this->updateTitle();
+  this->viewport()->update();
+}
+
+void LayoutView::updateScrollBars()
+{
+  int width = LAYOUT_TILE * LAYOUT_COLUMNS;
+  int height = this->mapHeight();
+
+  this->horizontalScrollBar()->setRange(0, std::max(0, width - this->viewport()->width()));
+  this->horizontalScrollBar()->setPageStep(this->viewport()->width());
+  this->verticalScrollBar()->setRange(0, std::max(0, height - this->viewport()->height()));
+  this->verticalScrollBar()->setPageStep(this->viewport()->height());
+  this->verticalScrollBar()->setSingleStep(LAYOUT_TILE / 8);
+}
+
+void LayoutView::updateTitle()
+{
+  const char *names[] = {"functions", "objects", "heat"};
+  double bpp = this->bytesPerPixel();
+
+  this->setWindowTitle(QString("Layout by %1, %2 bytes per pixel")
+                       .arg(names[this->overlay]).arg(bpp));
+}
+
+void LayoutView::paintEvent(QPaintEvent *event)
+{
+  QPainter painter(this->viewport());
+  painter.fillRect(event->rect(), Qt::black);
+
+  if (!this->index)
+    return;
+
+  int left = this->horizontalScrollBar()->value();
+  int top = this->verticalScrollBar()->value();
+  QRect visible = event->rect().translated(left, top);
+  int rows = (this->mapHeight() + LAYOUT_TILE - 1) / LAYOUT_TILE;
+
+  for (int ty = visible.top() / LAYOUT_TILE; ty <= visible.bottom() / LAYOUT_TILE && ty < rows; ++ty)
+    for (int tx = visible.left() / LAYOUT_TILE; tx <= visible.right() / LAYOUT_TILE && tx < LAYOUT_COLUMNS; ++tx)
+      {
+        qint64 key = (qint64) ty * LAYOUT_COLUMNS + tx;
+        QPoint at(tx * LAYOUT_TILE - left, ty * LAYOUT_TILE - top);
+        auto it = this->tiles.find(key);
+
+        if (it != this->tiles.end())
+          {
+            painter.drawImage(at, *it);
+            continue;
+          }
+
+        painter.fillRect(QRect(at, QSize(LAYOUT_TILE, LAYOUT_TILE)), QColor(24, 24, 24));
+
+        if (!this->pending.contains(key))
+          {
+            this->pending.insert(key);
+            this->pool.start(new TileJob(this, this->index, this->overlay, this->bytesPerPixel(),
+                                         tx, ty, this->generation));
+          }
+      }
+}
+
+void LayoutView::tileReady(int gen, qint64 key, QImage image)
+{
+  if (gen != this->generation)
+    return;
+
+  this->pending.remove(key);
+
+  // the tiles off screen go first when there are too many
+  if (this->tiles.size() >= MAX_TILES)
+    {
+      int top = this->verticalScrollBar()->value() / LAYOUT_TILE;
+      int bottom = (this->verticalScrollBar()->value() + this->viewport()->height()) / LAYOUT_TILE;
+
+      for (auto it = this->tiles.begin(); it != this->tiles.end(); )
+        {
+          int ty = it.key() / LAYOUT_COLUMNS;
+
+          if (ty < top || ty > bottom)
+            it = this->tiles.erase(it);
+          else
+            ++it;
+        }
+    }
+
+  this->tiles.insert(key, image);
+
+  int tx = key % LAYOUT_COLUMNS;
+  int ty = key / LAYOUT_COLUMNS;
+
+  this->viewport()->update(QRect(tx * LAYOUT_TILE - this->horizontalScrollBar()->value(),
+                                 ty * LAYOUT_TILE - this->verticalScrollBar()->value(),
+                                 LAYOUT_TILE, LAYOUT_TILE));
+}
+
+void LayoutView::resizeEvent(QResizeEvent *event)
+{
+  QAbstractScrollArea::resizeEvent(event);
+  this->updateScrollBars();
+}
+
+void LayoutView::wheelEvent(QWheelEvent *event)
+{
+  if ((event->modifiers() & Qt::ControlModifier) == 0)
+    {
+      QAbstractScrollArea::wheelEvent(event);
+      return;
+    }
+
+  this->zoom(event->angleDelta().y() > 0 ? 1 : -1, event->pos());
+}
+
+void LayoutView::keyPressEvent(QKeyEvent *event)
+{
+  QPoint center(this->viewport()->width() / 2, this->viewport()->height() / 2);
+
+  switch (event->key())
+    {
+    case Qt::Key_F:
+      this->setOverlay(LAYOUT_FUNCTIONS);
+      break;
+    case Qt::Key_O:
+      this->setOverlay(LAYOUT_OBJECTS);
+      break;
+    case Qt::Key_H:
+      this->setOverlay(LAYOUT_HEAT);
+      break;
+    case Qt::Key_Plus:
+    case Qt::Key_Equal:
+      this->zoom(1, center);
+      break;
+    case Qt::Key_Minus:
+      this->zoom(-1, center);
+      break;
+    default:
+      QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+// the function under the mouse, with its object and heat
+bool LayoutView::viewportEvent(QEvent *event)
+{
+  if (event->type() != QEvent::ToolTip || !this->index)
+    return QAbstractScrollArea::viewportEvent(event);
+
+  QHelpEvent *help = (QHelpEvent *) event;
+  const LayoutBlock *B = this->index->blockAt(this->addressAt(help->pos()));
+
+  if (B == NULL)
+    {
+      QToolTip::hideText();
+      return true;
+    }
+
+  QString text = QString("%1\n0x%2, %3 bytes").arg(QString::fromStdString(B->name))
+                 .arg(B->vma, 0, 16).arg(B->size);
+
+  if (B->owner >= 0)
+    text += "\n" + QString::fromStdString(this->index->getOwners()[B->owner]);
+  if (B->heat > 0)
+    text += QString("\nheat %1").arg(B->heat);
+
+  QToolTip::showText(help->globalPos(), text, this->viewport());
+  return true;
+}
@@ -0,0 +1,76 @@
+#ifndef LAYOUTVIEW_H
+#define LAYOUTVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QThreadPool>
+#include <QImage>
+#include <QHash>
+#include <QSet>
+#include <memory>
+
+#include "layoutindex.h"
+
+// side of a square tile, in pixels
+const int LAYOUT_TILE = 256;
+// tiles across the map, an address row is this many tiles wide
+const int LAYOUT_COLUMNS = 4;
+
+const int LAYOUT_FUNCTIONS = 0;
+const int LAYOUT_OBJECTS = 1;
+const int LAYOUT_HEAT = 2;
+
+// The address space of the executable as a raster read like text, left
+// to right and then down, each function a run of pixels as long as its
+// size. Coloring tells apart neighbouring functions, the objects they
+// come from or how hot a profile found them. The map is drawn in tiles
+// that are rendered on a thread pool and kept until the zoom or the
+// coloring changes, so scrolling only draws images.
+// F, O and H pick the coloring, Ctrl+wheel and +/- zoom.
+class LayoutView : public QAbstractScrollArea
+{
+  Q_OBJECT
+
+public:
+  explicit LayoutView(QWidget *parent = 0);
+  ~LayoutView();
+
+  void setIndex(std::shared_ptr<const LayoutIndex>);
+  void setOverlay(int);
+
+  // draws one tile, the pool threads call it
+  static QImage renderTile(const LayoutIndex &, int, double, int, int);
+
+protected:
+  void paintEvent(QPaintEvent *);
+  void resizeEvent(QResizeEvent *);
+  void wheelEvent(QWheelEvent *);
+  void keyPressEvent(QKeyEvent *);
+  bool viewportEvent(QEvent *);
+
+private slots:
+  void tileReady(int, qint64, QImage);
+
+private:
+  double bytesPerPixel() const;
+  int mapHeight() const;
+  uint64_t addressAt(QPoint) const;
+  void zoom(int, QPoint);
+  void reset();
+  void updateScrollBars();
+  void updateTitle();
+
+  std::shared_ptr<const LayoutIndex> index;
+  int overlay;
+
+  // bytes per pixel is 2 to the zoom
+  int zoomLevel;
+
+  // tiles of an older zoom or coloring are dropped when they arrive
+  int generation;
+  QHash<qint64, QImage> tiles;
+  QSet<qint64> pending;
+
+  QThreadPool pool;
+};
+
+#endif // LAYOUTVIEW_H
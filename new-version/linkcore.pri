@@ -0,0 +1,8 @@
+# what a program using the analysis core needs, the library is built by
+# elfdetective-core.pro in the same directory
+
+INCLUDEPATH += $$PWD
+QMAKE_CXXFLAGS += -std=c++11
+
+LIBS += -L$$OUT_PWD -lelfdetective-core -lbfd -lopcodes
+PRE_TARGETDEPS += $$OUT_PWD/libelfdetective-core.a
@@ -0,0 +1,616 @@
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "linkermap.h"
+
+// the map is read in blocks of this size, only a line that crosses two
+// blocks is copied
+const size_t MAP_BLOCK_SIZE = 1 << 20;
+
+static const char *skip_spaces(const char *p, const char *end)
+{
+  while (p < end && (*p == ' ' || *p == '\t'))
+    ++p;
+
+  return p;
+}
+
+static const char *skip_token(const char *p, const char *end)
+{
+  while (p < end && *p != ' ' && *p != '\t')
+    ++p;
+
+  return p;
+}
+
+// reads a hex number ending at a space or at the end of the line; GNU ld
+// and gold always print the 0x, lld never does
+static bool parse_hex(const char *&p, const char *end, bool prefix, uint64_t &value)
+{
+  const char *q = p;
+
+  if (prefix)
+    {
+      if (end - q < 2 || q[0] != '0' || (q[1] != 'x' && q[1] != 'X'))
+        return false;
+      q += 2;
+    }
+
+  const char *digits = q;
+  uint64_t v = 0;
+
+  for (; q < end; ++q)
+    {
+      int d;
+
+      if (*q >= '0' && *q <= '9')
+        d = *q - '0';
+      else if (*q >= 'a' && *q <= 'f')
+        d = *q - 'a' + 10;
+      else if (*q >= 'A' && *q <= 'F')
+        d = *q - 'A' + 10;
+      else
+        break;
+
+      v = (v << 4) | d;
+    }
+
+  if (q == digits || (q < end && *q != ' ' && *q != '\t'))
+    return false;
+
+  value = v;
+  p = q;
+  return true;
+}
+
+static size_t trimmed_length(const char *p, const char *end)
+{
+  while (end > p && (end[-1] == ' ' || end[-1] == '\t'))
+    --end;
+
+  return end - p;
+}
+
+// drops the "." and empty components and folds "dir/..", so the paths of
+// the map and of the opened files compare the same way
+static std::string normalize_path(const std::string &path)
+{
+  std::vector<std::string> parts;
+  std::istringstream iss(path);
+  std::string part;
+
+  while (std::getline(iss, part, '/'))
+    {
+      if (part.empty() || part == ".")
+        continue;
+
+      if (part == ".." && !parts.empty() && parts.back() != "..")
+        parts.pop_back();
+      else
+        parts.push_back(part);
+    }
+
+  std::string normalized = (!path.empty() && path[0] == '/') ? "/" : "";
+
+  for (size_t i = 0; i < parts.size(); ++i)
+    normalized += (i ? "/" : "") + parts[i];
+
+  return normalized;
+}
+
+// splits a file of the map, "dir/lib.a(m.o)", into the normalized path
+// and the member name
+static void split_file(const std::string &file, std::string &path, std::string &member)
+{
+  size_t open = file.rfind('(');
+
+  if (!file.empty() && file.back() == ')' && open != std::string::npos)
+    {
+      path = normalize_path(file.substr(0, open));
+      member = file.substr(open + 1, file.size() - open - 2);
+    }
+  else
+    {
+      path = normalize_path(file);
+      member.clear();
+    }
+}
+
+// input sections are indexed by the file name, member and section name,
+// the directories are compared on lookup
+static std::string section_key(const std::string &path, const std::string &member,
+                               const std::string &section)
+{
+  return path.substr(path.rfind('/') + 1) + '\0' + member + '\0' + section;
+}
+
+// how many trailing components two normalized paths share; the map has
+// the paths given to the linker, which may be relative to another
+// directory than the ones opened here
+static size_t common_components(const std::string &a, const std::string &b)
+{
+  size_t i = a.size(), j = b.size(), count = 0;
+
+  while (i > 0 && j > 0)
+    {
+      size_t ai = a.rfind('/', i - 1), bj = b.rfind('/', j - 1);
+      size_t as = (ai == std::string::npos) ? 0 : ai + 1;
+      size_t bs = (bj == std::string::npos) ? 0 : bj + 1;
+
+      if (a.compare(as, i - as, b, bs, j - bs) != 0)
+        break;
+
+      ++count;
+      i = (ai == std::string::npos) ? 0 : ai;
+      j = (bj == std::string::npos) ? 0 : bj;
+    }
+
+  return count;
+}
+
+bool LinkerMap::load(const std::string &path, const std::unordered_set<std::string> *wantedSymbols)
+{
+  this->flavour = MAP_UNKNOWN;
+  this->inMap = false;
+  this->pendingOutput.clear();
+  this->pendingInput.clear();
+  this->strings.clear();
+  this->stringIds.clear();
+  this->currentOutput = this->intern("", 0);
+  this->sections.clear();
+  this->symbols.clear();
+  this->byFileSection.clear();
+  this->wanted = wantedSymbols;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  std::vector<char> block(MAP_BLOCK_SIZE);
+  std::string carry;
+  bool ok = true;
+
+  for (;;)
+    {
+      ssize_t n = read(fd, &block[0], block.size());
+
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0)
+        {
+          ok = false;
+          break;
+        }
+      if (n == 0)
+        break;
+
+      const char *p = &block[0];
+      const char *end = p + n;
+
+      while (p < end)
+        {
+          const char *nl = (const char *) memchr(p, '\n', end - p);
+
+          if (nl == NULL)
+            {
+              carry.append(p, end - p);
+              break;
+            }
+
+          if (!carry.empty())
+            {
+              carry.append(p, nl - p);
+              this->parseLine(carry.data(), carry.size());
+              carry.clear();
+            }
+          else
+            this->parseLine(p, nl - p);
+
+          p = nl + 1;
+        }
+    }
+
+  close(fd);
+
+  if (!carry.empty())
+    this->parseLine(carry.data(), carry.size());
+
+  this->wanted = NULL;
+
+  std::stable_sort(this->sections.begin(), this->sections.end(),
+                   [](const MapSection &a, const MapSection &b) {return a.vma < b.vma;});
+
+  for (size_t i = 0; i < this->sections.size(); ++i)
+    {
+      const MapSection &S = this->sections[i];
+      std::string path, member;
+
+      split_file(this->strings[S.file], path, member);
+
+      // the first input section of every file
+      std::vector<size_t> &found = this->byFileSection[section_key(path, member,
+                                                                   this->strings[S.name])];
+      bool seen = false;
+
+      for (size_t k : found)
+        seen = seen || this->sections[k].file == S.file;
+
+      if (!seen)
+        found.push_back(i);
+    }
+
+  return ok && this->flavour != MAP_UNKNOWN;
+}
+
+int LinkerMap::getFlavour() const
+{
+  return this->flavour;
+}
+
+size_t LinkerMap::getSectionCount() const
+{
+  return this->sections.size();
+}
+
+size_t LinkerMap::getSymbolCount() const
+{
+  return this->symbols.size();
+}
+
+const MapSection *LinkerMap::attribute(uint64_t vma) const
+{
+  auto it = std::upper_bound(this->sections.begin(), this->sections.end(), vma,
+                             [](uint64_t v, const MapSection &S) {return v < S.vma;});
+
+  // sections may overlap, like .tbss, so look back a little
+  for (int tries = 0; it != this->sections.begin() && tries < 4; ++tries)
+    {
+      --it;
+      if (vma - it->vma < it->size)
+        return &*it;
+    }
+
+  return NULL;
+}
+
+std::string LinkerMap::describe(const MapSection *S) const
+{
+  if (S == NULL)
+    return "";
+
+  return this->strings[S->file] + ":(" + this->strings[S->name] + ") in "
+      + this->strings[S->output];
+}
+
+std::vector<MapMismatch> LinkerMap::check(const AddressBinding &AB, size_t *checked) const
+{
+  std::vector<MapMismatch> mismatches;
+  size_t count = 0;
+
+  for (const std::string &name : AB.getSymbols())
+    {
+      Symbol S = AB.getSymbol(name);
+
+      if (!S.defined || !S.placed)
+        continue;
+
+      ++count;
+
+      MapMismatch M;
+
+      M.symbol = name;
+      M.file = S.defined_in;
+      M.section = S.defined_section;
+      M.found = S.exe_vma;
+
+      auto sym = this->symbols.find(name);
+      if (sym != this->symbols.end() && sym->second != S.exe_vma)
+        {
+          M.expected = sym->second;
+          M.bySymbol = true;
+          mismatches.push_back(M);
+          continue;
+        }
+
+      // the symbol is at the same offset in its input section
+      std::string path = normalize_path(S.defined_path);
+      auto sec = this->byFileSection.find(section_key(path, S.defined_member,
+                                                      S.defined_section));
+      if (sec == this->byFileSection.end())
+        continue;
+
+      // the file whose directories match best, none when two match as well
+      const MapSection *input = NULL;
+      size_t best = 0;
+
+      for (size_t k : sec->second)
+        {
+          std::string mapPath, mapMember;
+
+          split_file(this->strings[this->sections[k].file], mapPath, mapMember);
+
+          size_t n = common_components(mapPath, path);
+          if (n > best)
+            {
+              best = n;
+              input = &this->sections[k];
+            }
+          else if (n == best)
+            input = NULL;
+        }
+
+      if (input != NULL && input->vma + S.def_vma != S.exe_vma)
+        {
+          M.expected = input->vma + S.def_vma;
+          M.bySymbol = false;
+          mismatches.push_back(M);
+        }
+    }
+
+  if (checked != NULL)
+    *checked = count;
+
+  return mismatches;
+}
+
+void LinkerMap::parseLine(const char *line, size_t len)
+{
+  if (len > 0 && line[len - 1] == '\r')
+    --len;
+
+  if (!this->inMap)
+    {
+      this->inMap = this->findHeader(line, len);
+      return;
+    }
+
+  if (this->flavour == MAP_LLD)
+    this->parseLld(line, len);
+  else
+    this->parseGnu(line, len);
+}
+
+// GNU ld and gold print the memory map after a title, lld starts with
+// the header of its columns
+bool LinkerMap::findHeader(const char *line, size_t len)
+{
+  std::string L(line, len);
+
+  if (L.compare(0, 28, "Linker script and memory map") == 0)
+    {
+      this->flavour = MAP_GNU_LD;
+      return true;
+    }
+
+  if (L.compare(0, 10, "Memory map") == 0)
+    {
+      this->flavour = MAP_GOLD;
+      return true;
+    }
+
+  size_t out = L.find(" Out ");
+  size_t in = L.find(" In ");
+  size_t symbol = L.find(" Symbol");
+
+  if ((L.find("VMA") != std::string::npos || L.find("Address") != std::string::npos)
+      && out != std::string::npos && in != std::string::npos && symbol != std::string::npos)
+    {
+      this->flavour = MAP_LLD;
+      this->outColumn = out + 1;
+      this->inColumn = in + 1;
+      this->symbolColumn = symbol + 1;
+      return true;
+    }
+
+  return false;
+}
+
+// output sections start the line, input sections are indented by one
+// space and symbols by more; names too long for their column are alone
+// on their line and the numbers follow on the next one
+void LinkerMap::parseGnu(const char *line, size_t len)
+{
+  const char *end = line + len;
+  const char *p;
+  uint64_t vma, size;
+
+  if (len == 0)
+    {
+      this->pendingOutput.clear();
+      this->pendingInput.clear();
+      return;
+    }
+
+  if (line[0] != ' ')
+    {
+      this->pendingInput.clear();
+      this->pendingOutput.clear();
+
+      const char *name = line;
+      p = skip_token(line, end);
+      size_t nameLen = p - name;
+      p = skip_spaces(p, end);
+
+      if (p == end)
+        this->pendingOutput.assign(name, nameLen);
+      else if (parse_hex(p, end, true, vma))
+        this->currentOutput = this->intern(name, nameLen);
+
+      return;
+    }
+
+  if (line[1] != ' ')
+    {
+      this->pendingInput.clear();
+      this->pendingOutput.clear();
+
+      // patterns, *fill* and the gold ** lines
+      if (line[1] == '*' || line[1] == '\t')
+        return;
+
+      const char *name = line + 1;
+      p = skip_token(name, end);
+      size_t nameLen = p - name;
+      p = skip_spaces(p, end);
+
+      if (p == end)
+        this->pendingInput.assign(name, nameLen);
+      else if (parse_hex(p, end, true, vma) && parse_hex(p = skip_spaces(p, end), end, true, size))
+        {
+          p = skip_spaces(p, end);
+          this->addSection(name, nameLen, p, trimmed_length(p, end), vma, size);
+        }
+
+      return;
+    }
+
+  p = skip_spaces(line, end);
+
+  if (!this->pendingOutput.empty())
+    {
+      if (parse_hex(p, end, true, vma))
+        this->currentOutput = this->intern(this->pendingOutput.data(), this->pendingOutput.size());
+
+      this->pendingOutput.clear();
+      return;
+    }
+
+  if (!this->pendingInput.empty())
+    {
+      if (parse_hex(p, end, true, vma) && parse_hex(p = skip_spaces(p, end), end, true, size))
+        {
+          p = skip_spaces(p, end);
+          this->addSection(this->pendingInput.data(), this->pendingInput.size(),
+                           p, trimmed_length(p, end), vma, size);
+        }
+
+      this->pendingInput.clear();
+      return;
+    }
+
+  if (!parse_hex(p, end, true, vma))
+    return;
+
+  p = skip_spaces(p, end);
+  size_t nameLen = trimmed_length(p, end);
+
+  // assignments and PROVIDE lines aren't symbols of an input section
+  if (nameLen == 0 || memchr(p, '=', nameLen) != NULL
+      || (nameLen > 1 && p[0] == '0' && p[1] == 'x'))
+    return;
+
+  this->addSymbol(p, nameLen, vma);
+}
+
+// lld prints the addresses in columns and indents the text by what it is:
+// output sections in Out, input sections in In, symbols in Symbol
+void LinkerMap::parseLld(const char *line, size_t len)
+{
+  const char *end = line + len;
+  const char *p = line;
+  uint64_t fields[4];
+  int n = 0;
+
+  while (n < 4 && (size_t) ((p = skip_spaces(p, end)) - line) < this->outColumn)
+    if (!parse_hex(p, end, false, fields[n++]))
+      return;
+
+  if (n < 3)
+    return;
+
+  p = skip_spaces(p, end);
+  size_t column = p - line;
+  size_t textLen = trimmed_length(p, end);
+
+  if (textLen == 0)
+    return;
+
+  // Align is the last number and Size the one before it
+  uint64_t vma = fields[0];
+  uint64_t size = fields[n - 2];
+
+  if (column < this->inColumn)
+    {
+      this->currentOutput = this->intern(p, textLen);
+      return;
+    }
+
+  if (column < this->symbolColumn)
+    {
+      // file:(section), the file may be an archive member
+      const char *q = p + textLen;
+
+      while (q > p + 1 && !(q[-2] == ':' && q[-1] == '('))
+        --q;
+
+      if (q <= p + 1 || p[textLen - 1] != ')')
+        return;
+
+      this->addSection(q, p + textLen - 1 - q, p, q - 2 - p, vma, size);
+      return;
+    }
+
+  if (memchr(p, '=', textLen) == NULL)
+    this->addSymbol(p, textLen, vma);
+}
+
+void LinkerMap::addSection(const char *name, size_t nameLen, const char *file, size_t fileLen,
+                           uint64_t vma, uint64_t size)
+{
+  // empty sections can't hold anything and aren't kept
+  if (size == 0 || fileLen == 0)
+    return;
+
+  MapSection S;
+
+  S.output = this->currentOutput;
+  S.name = this->intern(name, nameLen);
+  S.file = this->intern(file, fileLen);
+  S.vma = vma;
+  S.size = size;
+
+  this->sections.push_back(S);
+}
+
+void LinkerMap::addSymbol(const char *name, size_t len, uint64_t vma)
+{
+  std::string S(name, len);
+
+  if (this->wanted != NULL && this->wanted->find(S) == this->wanted->end())
+    return;
+
+  this->symbols.emplace(S, vma);
+}
+
+// file and section names repeat on every line, they are stored once
+uint32_t LinkerMap::intern(const char *s, size_t len)
+{
+  std::string key(s, len);
+  auto it = this->stringIds.find(key);
+
+  if (it != this->stringIds.end())
+    return it->second;
+
+  uint32_t id = this->strings.size();
+
+  this->strings.push_back(key);
+  this->stringIds.emplace(key, id);
+
+  return id;
+}
+
+LinkerMap::LinkerMap()
+  : flavour(MAP_UNKNOWN), inMap(false), outColumn(0), inColumn(0), symbolColumn(0),
+    currentOutput(0), wanted(NULL)
+{}
+
+LinkerMap::~LinkerMap()
+{}
@@ -0,0 +1,101 @@
+#ifndef LINKERMAP_H
+#define LINKERMAP_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "addressbinding.h"
+
+const int MAP_UNKNOWN = 0;
+const int MAP_GNU_LD = 1;
+const int MAP_GOLD = 2;
+const int MAP_LLD = 3;
+
+// an input section as the map placed it; the names are indexes in the
+// map's string pool
+struct MapSection
+{
+  uint32_t output;
+  uint32_t name;
+  uint32_t file;
+  uint64_t vma;
+  uint64_t size;
+};
+
+struct MapMismatch
+{
+  std::string symbol;
+  std::string file;
+  std::string section;
+  uint64_t expected;            // from the map
+  uint64_t found;               // from the executable
+  bool bySymbol;                // the map lists the symbol, else its section
+};
+
+// A linker map file of GNU ld, gold or lld, read as a stream: the file is
+// read in fixed-size blocks and parsed line by line, so memory only grows
+// with the input sections kept and the symbols asked for, not with the
+// size of the map. The input sections say which object every address of
+// the executable came from, even when its symbols were stripped.
+class LinkerMap
+{
+public:
+  // symbols not in *wanted* are skipped, a NULL set keeps all of them
+  bool load(const std::string &, const std::unordered_set<std::string> *);
+
+  int getFlavour() const;
+  size_t getSectionCount() const;
+  size_t getSymbolCount() const;
+
+  // the input section holding an address, or NULL
+  const MapSection *attribute(uint64_t) const;
+  std::string describe(const MapSection *) const;
+
+  // compares where the map put every defined symbol, and the input
+  // section it comes from, with its address in the executable
+  std::vector<MapMismatch> check(const AddressBinding &, size_t *) const;
+
+  LinkerMap();
+  virtual ~LinkerMap();
+
+protected:
+private:
+  void parseLine(const char *, size_t);
+  void parseGnu(const char *, size_t);
+  void parseLld(const char *, size_t);
+  bool findHeader(const char *, size_t);
+
+  void addSection(const char *, size_t, const char *, size_t, uint64_t, uint64_t);
+  void addSymbol(const char *, size_t, uint64_t);
+  uint32_t intern(const char *, size_t);
+
+  int flavour;
+  bool inMap;
+
+  // lld: where the Out, In and Symbol columns start
+  size_t outColumn;
+  size_t inColumn;
+  size_t symbolColumn;
+
+  // GNU ld and gold wrap long section names onto their own line
+  std::string pendingOutput;
+  std::string pendingInput;
+  uint32_t currentOutput;
+
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, uint32_t> stringIds;
+
+  std::vector<MapSection> sections;
+  std::unordered_map<std::string, uint64_t> symbols;
+  const std::unordered_set<std::string> *wanted;
+
+  // (file name, member, section name) to the first input section of
+  // every file with them, whatever its directory
+  std::unordered_map<std::string, std::vector<size_t> > byFileSection;
+};
+
+#endif // LINKERMAP_H
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "linkverifier.h"
+#include "tools.h"
+#include "elf-bfd.h"
+#include "elf/x86-64.h"
+#include "elf/i386.h"
+#include "elf/aarch64.h"
+
+// relocations the verifier knows how to compute, the GOT and TLS ones
+// are left out since linkers are free to relax them
+static const RelocFormula x86_64_formulas[] =
+{
+  { R_X86_64_64,        VERIFY_ABS,   FIELD_PLAIN, false, 8, 0, 0, 64 },
+  { R_X86_64_PC32,      VERIFY_PCREL, FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_X86_64_PLT32,     VERIFY_PLT,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_X86_64_32,        VERIFY_ABS,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_X86_64_32S,       VERIFY_ABS,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_X86_64_16,        VERIFY_ABS,   FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_X86_64_PC16,      VERIFY_PCREL, FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_X86_64_8,         VERIFY_ABS,   FIELD_PLAIN, false, 1, 0, 0, 8 },
+  { R_X86_64_PC8,       VERIFY_PCREL, FIELD_PLAIN, false, 1, 0, 0, 8 },
+  { R_X86_64_PC64,      VERIFY_PCREL, FIELD_PLAIN, false, 8, 0, 0, 64 },
+  { R_X86_64_PLT32_BND, VERIFY_PLT,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+};
+
+static const RelocFormula i386_formulas[] =
+{
+  { R_386_32,    VERIFY_ABS,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_386_PC32,  VERIFY_PCREL, FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_386_PLT32, VERIFY_PLT,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_386_16,    VERIFY_ABS,   FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_386_PC16,  VERIFY_PCREL, FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_386_8,     VERIFY_ABS,   FIELD_PLAIN, false, 1, 0, 0, 8 },
+  { R_386_PC8,   VERIFY_PCREL, FIELD_PLAIN, false, 1, 0, 0, 8 },
+};
+
+static const RelocFormula aarch64_formulas[] =
+{
+  { R_AARCH64_ABS64,               VERIFY_ABS,   FIELD_PLAIN, false, 8, 0, 0, 64 },
+  { R_AARCH64_ABS32,               VERIFY_ABS,   FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_AARCH64_ABS16,               VERIFY_ABS,   FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_AARCH64_PREL64,              VERIFY_PCREL, FIELD_PLAIN, false, 8, 0, 0, 64 },
+  { R_AARCH64_PREL32,              VERIFY_PCREL, FIELD_PLAIN, false, 4, 0, 0, 32 },
+  { R_AARCH64_PREL16,              VERIFY_PCREL, FIELD_PLAIN, false, 2, 0, 0, 16 },
+  { R_AARCH64_LD_PREL_LO19,        VERIFY_PCREL, FIELD_PLAIN, false, 4, 2, 5, 19 },
+  { R_AARCH64_ADR_PREL_LO21,       VERIFY_PCREL, FIELD_ADR,   false, 4, 0, 0, 21 },
+  { R_AARCH64_ADR_PREL_PG_HI21,    VERIFY_PAGE,  FIELD_ADR,   false, 4, 12, 0, 21 },
+  { R_AARCH64_ADR_PREL_PG_HI21_NC, VERIFY_PAGE,  FIELD_ADR,   false, 4, 12, 0, 21 },
+  { R_AARCH64_ADD_ABS_LO12_NC,     VERIFY_ABS,   FIELD_PLAIN, true,  4, 0, 10, 12 },
+  { R_AARCH64_LDST8_ABS_LO12_NC,   VERIFY_ABS,   FIELD_PLAIN, true,  4, 0, 10, 12 },
+  { R_AARCH64_LDST16_ABS_LO12_NC,  VERIFY_ABS,   FIELD_PLAIN, true,  4, 1, 10, 11 },
+  { R_AARCH64_LDST32_ABS_LO12_NC,  VERIFY_ABS,   FIELD_PLAIN, true,  4, 2, 10, 10 },
+  { R_AARCH64_LDST64_ABS_LO12_NC,  VERIFY_ABS,   FIELD_PLAIN, true,  4, 3, 10, 9 },
+  { R_AARCH64_LDST128_ABS_LO12_NC, VERIFY_ABS,   FIELD_PLAIN, true,  4, 4, 10, 8 },
+  { R_AARCH64_TSTBR14,             VERIFY_PCREL, FIELD_PLAIN, false, 4, 2, 5, 14 },
+  { R_AARCH64_CONDBR19,            VERIFY_PCREL, FIELD_PLAIN, false, 4, 2, 5, 19 },
+  { R_AARCH64_JUMP26,              VERIFY_PLT,   FIELD_PLAIN, false, 4, 2, 0, 26 },
+  { R_AARCH64_CALL26,              VERIFY_PLT,   FIELD_PLAIN, false, 4, 2, 0, 26 },
+};
+
+#define FORMULA_COUNT(T) (sizeof(T) / sizeof((T)[0]))
+
+static bfd_vma field_mask(unsigned int bits)
+{
+  return (bits >= 64) ? (bfd_vma) -1 : (((bfd_vma) 1 << bits) - 1);
+}
+
+static bfd_vma sign_extend(bfd_vma value, unsigned int bits)
+{
+  if (bits >= 64)
+    return value;
+
+  bfd_vma sign = (bfd_vma) 1 << (bits - 1);
+
+  return ((value & field_mask(bits)) ^ sign) - sign;
+}
+
+// reads the immediate a formula describes out of an instruction or word
+static bfd_vma read_field(const RelocFormula *F, const unsigned char *at, bool big)
+{
+  bfd_vma word = bfd_get_bits(at, F->size * 8, big);
+
+  if (F->field == FIELD_ADR)
+    return ((word >> 29) & 3) | (((word >> 5) & 0x7ffff) << 2);
+
+  return (word >> F->bitpos) & field_mask(F->bits);
+}
+
+const RelocFormula *LinkVerifier::formula(bfd *abfd, unsigned int type)
+{
+  const RelocFormula *table = NULL;
+  size_t count = 0;
+
+  switch (bfd_get_arch(abfd))
+    {
+    case bfd_arch_i386:
+      if (bfd_get_mach(abfd) & (bfd_mach_x86_64 | bfd_mach_x64_32))
+        {
+          table = x86_64_formulas;
+          count = FORMULA_COUNT(x86_64_formulas);
+        }
+      else
+        {
+          table = i386_formulas;
+          count = FORMULA_COUNT(i386_formulas);
+        }
+      break;
+    case bfd_arch_aarch64:
+      table = aarch64_formulas;
+      count = FORMULA_COUNT(aarch64_formulas);
+      break;
+    default:
+      break;
+    }
+
+  for (size_t i = 0; i < count; ++i)
+    if (table[i].type == type)
+      return &table[i];
+
+  return NULL;
+}
+
+std::vector<RelocTypeReport> LinkVerifier::verify()
+{
+  std::lock_guard<std::recursive_mutex> lock(bfd_lock());
+  std::vector<RelocTypeReport> reports;
+
+  this->exeMap = map_file(this->exefile->getPath().c_str(), &this->exeSize);
+  if (this->exeMap == NULL)
+    return reports;
+
+  this->exeRanges.clear();
+  for (asection *section = this->exefile->getBfd()->sections; section != NULL; section = section->next)
+    {
+      if ((section->flags & SEC_HAS_CONTENTS) == 0 || (section->flags & SEC_ALLOC) == 0)
+        continue;
+
+      ExeRange R;
+
+      R.vma = section->vma;
+      R.end = section->vma + bfd_get_section_size(section);
+      R.filepos = section->filepos;
+      R.plt = strncmp(section->name, ".plt", 4) == 0 || strncmp(section->name, ".iplt", 5) == 0;
+      this->exeRanges.push_back(R);
+    }
+
+  std::sort(this->exeRanges.begin(), this->exeRanges.end(),
+            [](const ExeRange &a, const ExeRange &b) {return a.vma < b.vma;});
+
+  // bfd isn't thread safe, so the relocation tables are loaded here
+  // and only the checks run on the workers
+  std::vector<std::vector<RelocSection> > relocs(this->objfiles.size());
+  std::vector<PlacementMap> placements(this->objfiles.size());
+  std::vector<const unsigned char *> maps(this->objfiles.size());
+  std::vector<size_t> sizes(this->objfiles.size());
+  // where every object starts in its mapped file, past the archive
+  // header for an archive member
+  std::vector<file_ptr> origins(this->objfiles.size(), 0);
+
+  for (size_t i = 0; i < this->objfiles.size(); ++i)
+    {
+      ELFFile *E = this->objfiles[i];
+      bfd *abfd = E->getBfd();
+
+      const RelocTable &table = E->getRelocs();
+
+      // only global names place a section, the binding keeps one
+      // definition of a local name for all the objects using it
+      placements[i] = this->AB->placeSections(E);
+      // a member of a thin archive is a file of its own, the others are
+      // read from the archive itself
+      std::string path = E->getPath();
+
+      if (abfd->my_archive != NULL && bfd_is_thin_archive(abfd->my_archive))
+        path = bfd_get_filename(abfd);
+      else if (abfd->my_archive != NULL)
+        origins[i] = abfd->origin;
+
+      maps[i] = map_file(path.c_str(), &sizes[i]);
+
+      if (origins[i] > (file_ptr) sizes[i])
+        origins[i] = sizes[i];
+
+      for (asection *section = abfd->sections; section != NULL; section = section->next)
+        {
+          auto placed = placements[i].find(section);
+
+          if (table.count(section) == 0 || placed == placements[i].end())
+            continue;
+
+          RelocSection R;
+
+          R.section = section;
+          R.placement = placed->second;
+          R.relbuf = table.begin(section);
+          R.relcount = table.count(section);
+
+          relocs[i].push_back(R);
+        }
+    }
+
+  // objects are handed out to the workers one at a time
+  std::vector<ReportMap> results(this->objfiles.size());
+  std::atomic<size_t> next(0);
+  size_t threads = worker_count(this->objfiles.size());
+
+  auto worker = [&]()
+    {
+      for (size_t k = next++; k < this->objfiles.size(); k = next++)
+        this->verifyObject(this->objfiles[k],
+                           (maps[k] != NULL) ? maps[k] + origins[k] : NULL,
+                           sizes[k] - origins[k], relocs[k], placements[k], results[k]);
+    };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t = 1; t < threads; ++t)
+    workers.push_back(std::thread(worker));
+
+  if (threads)
+    worker();
+
+  for (std::thread &t : workers)
+    t.join();
+
+  // group everything by relocation type, objects keep their order
+  ReportMap merged;
+
+  for (size_t i = 0; i < results.size(); ++i)
+    {
+      for (auto it = results[i].begin(); it != results[i].end(); ++it)
+        {
+          RelocTypeReport &R = merged[it->first];
+
+          if (R.type.empty())
+            {
+              R.type = it->first;
+              R.checked = R.skipped = 0;
+            }
+
+          R.checked += it->second.checked;
+          R.skipped += it->second.skipped;
+          R.mismatches.insert(R.mismatches.end(), it->second.mismatches.begin(),
+                              it->second.mismatches.end());
+        }
+
+      unmap_file(maps[i], sizes[i]);
+    }
+
+  for (auto it = merged.begin(); it != merged.end(); ++it)
+    reports.push_back(it->second);
+
+  std::sort(reports.begin(), reports.end(),
+            [](const RelocTypeReport &a, const RelocTypeReport &b) {return a.type < b.type;});
+
+  unmap_file(this->exeMap, this->exeSize);
+  this->exeMap = NULL;
+  this->exeSize = 0;
+
+  return reports;
+}
+
+void LinkVerifier::verifyObject(ELFFile *E, const unsigned char *objMap, size_t objSize,
+                                const std::vector<RelocSection> &relocs,
+                                const PlacementMap &placed, ReportMap &reports) const
+{
+  bfd *abfd = E->getBfd();
+  bool big = bfd_big_endian(abfd);
+  unsigned int opb = bfd_octets_per_byte(abfd);
+
+  for (const RelocSection &RS : relocs)
+    {
+      for (long i = 0; i < RS.relcount; ++i)
+        {
+          arelent *q = RS.relbuf[i];
+
+          if (q->howto == NULL)
+            continue;
+
+          RelocTypeReport &R = reports[q->howto->name ? q->howto->name : "unknown"];
+          if (R.type.empty())
+            {
+              R.type = q->howto->name ? q->howto->name : "unknown";
+              R.checked = R.skipped = 0;
+            }
+
+          const RelocFormula *F = formula(abfd, q->howto->type);
+          asymbol *sym = (q->sym_ptr_ptr != NULL) ? *q->sym_ptr_ptr : NULL;
+          bfd_vma P = RS.placement + q->address;
+          bfd_vma S = 0;
+          bool known = true;
+
+          // symbol value
+          if (sym == NULL || bfd_is_abs_section(sym->section))
+            S = (sym == NULL) ? 0 : sym->value;
+          else if (bfd_is_und_section(sym->section) || bfd_is_com_section(sym->section))
+            {
+              const Symbol *B = this->AB->findSymbol(bfd_asymbol_name(sym));
+
+              if (B != nullptr && B->placed)
+                S = B->exe_vma;
+              else if ((sym->flags & BSF_WEAK) == 0)
+                known = false;
+            }
+          else
+            {
+              auto it = placed.find(sym->section);
+
+              if (it != placed.end())
+                S = it->second + sym->value;
+              else
+                known = false;
+            }
+
+          const unsigned char *found_at = (F != NULL) ? this->exeBytes(P, F->size) : NULL;
+
+          if (F == NULL || !known || found_at == NULL)
+            {
+              ++R.skipped;
+              continue;
+            }
+
+          // addend, REL targets keep it in the field itself
+          bfd_vma A = q->addend;
+
+          if (q->howto->partial_inplace)
+            {
+              file_ptr at = RS.section->filepos + q->address * opb;
+
+              if (objMap == NULL || at + F->size > (file_ptr) objSize)
+                {
+                  ++R.skipped;
+                  continue;
+                }
+
+              A = sign_extend(read_field(F, objMap + at, big), F->bits) << F->rightshift;
+            }
+
+          bfd_vma value;
+
+          switch (F->kind)
+            {
+            case VERIFY_ABS:
+              value = S + A;
+              break;
+            case VERIFY_PAGE:
+              value = ((S + A) & ~(bfd_vma) 0xfff) - (P & ~(bfd_vma) 0xfff);
+              break;
+            default:
+              value = S + A - P;
+              break;
+            }
+
+          if (F->lo12)
+            value &= 0xfff;
+
+          bfd_vma expected = (value >> F->rightshift) & field_mask(F->bits);
+          bfd_vma found = read_field(F, found_at, big);
+
+          ++R.checked;
+
+          if (expected == found)
+            continue;
+
+          // calls may go through the PLT instead of straight to S
+          if (F->kind == VERIFY_PLT)
+            {
+              const ExeRange *target = this->exeRange((sign_extend(found, F->bits) << F->rightshift) + P - A);
+
+              if (target != NULL && target->plt)
+                continue;
+            }
+
+          RelocMismatch M;
+
+          M.file = E->getName();
+          M.section = RS.section->name;
+          M.symbol = (sym != NULL) ? bfd_asymbol_name(sym) : "";
+          M.offset = q->address;
+          M.address = P;
+          M.expected = expected;
+          M.found = found;
+
+          R.mismatches.push_back(M);
+        }
+    }
+}
+
+const LinkVerifier::ExeRange *LinkVerifier::exeRange(bfd_vma vma) const
+{
+  auto it = std::upper_bound(this->exeRanges.begin(), this->exeRanges.end(), vma,
+                             [](bfd_vma v, const ExeRange &R) {return v < R.vma;});
+
+  if (it == this->exeRanges.begin())
+    return NULL;
+
+  --it;
+  return (vma < it->end) ? &*it : NULL;
+}
+
+// the executable's bytes at *vma*, if *size* of them are in one section
+const unsigned char *LinkVerifier::exeBytes(bfd_vma vma, unsigned int size) const
+{
+  const ExeRange *R = this->exeRange(vma);
+
+  if (R == NULL || vma + size > R->end)
+    return NULL;
+
+  size_t at = R->filepos + (vma - R->vma);
+  if (at + size > this->exeSize)
+    return NULL;
+
+  return this->exeMap + at;
+}
+
+LinkVerifier::LinkVerifier()
+{
+  this->exefile = nullptr;
+  this->AB = nullptr;
+  this->exeMap = NULL;
+  this->exeSize = 0;
+}
+
+LinkVerifier::LinkVerifier(std::vector<ELFFile *> objs, ELFFile *exe, AddressBinding *ab)
+  : objfiles(objs), exefile(exe), AB(ab)
+{
+  this->exeMap = NULL;
+  this->exeSize = 0;
+}
+
+LinkVerifier::~LinkVerifier()
+{
+  this->exefile = nullptr;
+  this->AB = nullptr;
+  this->objfiles.clear();
+}
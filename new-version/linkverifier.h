@@ -0,0 +1,107 @@
+#ifndef LINKVERIFIER_H
+#define LINKVERIFIER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "elffile.h"
+#include "addressbinding.h"
+
+// how the value a relocation writes is computed
+const int VERIFY_ABS = 0;       // S + A
+const int VERIFY_PCREL = 1;     // S + A - P
+const int VERIFY_PLT = 2;       // S + A - P, or a PLT entry
+const int VERIFY_PAGE = 3;      // Page(S + A) - Page(P)
+
+// how the value is stored in the field
+const int FIELD_PLAIN = 0;
+const int FIELD_ADR = 1;        // AArch64 adr/adrp split immediate
+
+struct RelocFormula
+{
+  unsigned int type;
+  int kind;
+  int field;
+  bool lo12;                    // only the low 12 bits of the value are used
+  unsigned int size;            // octets patched
+  unsigned int rightshift;
+  unsigned int bitpos;
+  unsigned int bits;
+};
+
+struct RelocMismatch
+{
+  std::string file;
+  std::string section;
+  std::string symbol;
+  bfd_vma offset;               // in the object section
+  bfd_vma address;              // P
+  bfd_vma expected;
+  bfd_vma found;
+};
+
+struct RelocTypeReport
+{
+  std::string type;
+  size_t checked;
+  size_t skipped;               // no formula, or S or P unknown
+  std::vector<RelocMismatch> mismatches;
+};
+
+// Checks the linker's work: for every relocation of every object it
+// computes the value the field should hold once S, A and P are known and
+// compares it with the bytes of the executable. P comes from where the
+// object's sections ended up, found through the symbols AddressBinding
+// placed; relocations in sections that can't be placed are skipped.
+class LinkVerifier
+{
+public:
+  std::vector<RelocTypeReport> verify();
+
+  // the formula for a relocation type of an architecture, or NULL
+  static const RelocFormula *formula(bfd *, unsigned int);
+
+  LinkVerifier();
+  LinkVerifier(std::vector<ELFFile *>, ELFFile *, AddressBinding *);
+  virtual ~LinkVerifier();
+
+protected:
+private:
+  // one object section and its relocations, read before the checks start
+  struct RelocSection
+  {
+    asection *section;
+    bfd_vma placement;
+    arelent **relbuf;
+    long relcount;
+  };
+
+  // where an executable section is in the mapped file
+  struct ExeRange
+  {
+    bfd_vma vma;
+    bfd_vma end;
+    file_ptr filepos;
+    bool plt;
+  };
+
+  typedef std::unordered_map<asection *, bfd_vma> PlacementMap;
+  typedef std::unordered_map<std::string, RelocTypeReport> ReportMap;
+
+  void verifyObject(ELFFile *, const unsigned char *, size_t,
+                    const std::vector<RelocSection> &,
+                    const PlacementMap &, ReportMap &) const;
+  const ExeRange *exeRange(bfd_vma) const;
+  const unsigned char *exeBytes(bfd_vma, unsigned int) const;
+
+  std::vector<ELFFile *> objfiles;
+  ELFFile *exefile;
+  AddressBinding *AB;
+
+  const unsigned char *exeMap;
+  size_t exeSize;
+  std::vector<ExeRange> exeRanges;
+};
+
+#endif // LINKVERIFIER_H
@@ -1,17 +1,28 @@
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QIcon>
+#include <QMenu>
+#include <QMenuBar>
 #include <QShortcut>
 #include <QSettings>
+#include <QStatusBar>
 #include <iostream>
 #include <vector>
 #include <sstream>
+#include <unordered_set>
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "objecttab.h"
 #include "disassemblemodule.h"
+#include "linkverifier.h"
+
+// functions are moved into the models at most this often, and at most
+// this many at a time, so a repaint stays cheap however fast they come
+const int DRAIN_INTERVAL = 100;
+const size_t MAX_DRAINED = 2000;
 
 MainWindow::MainWindow(QWidget *parent) :
   QMainWindow(parent),
@@ -19,7 +30,7 @@ MainWindow::MainWindow(QWidget *parent) :
 {
   ui->setupUi(this);
 
-  bfd_init();
+  init_core();
 
   // pages
   ui->exeToolBox->setItemText(0, "Data");
@@ -38,13 +49,42 @@ MainWindow::MainWindow(QWidget *parent) :
   ui->runProj->setIconSize(QSize(25, 25));
   ui->clearProj->setIconSize(QSize(25, 25));
 
-  // tabs
-  ui->objTabs->removeTab(0);
-  ui->objTabs->removeTab(0);
+  // objects, a list to find them in and one view for the selected one
+  this->objNames = new SymbolListModel(this);
+  this->objFilterModel = new QSortFilterProxyModel(this);
+  this->objFilterModel->setSourceModel(this->objNames);
+  this->objFilterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+  ui->objList->setModel(this->objFilterModel);
+  ui->objList->setUniformItemSizes(true);
+  ui->objSplitter->setStretchFactor(1, 3);
+
+  this->objView = new objecttab(ui->objDetail);
+  ui->objDetailLayout->addWidget(this->objView);
+  this->objView->hide();
+
+  connect(ui->objFilter, SIGNAL(textChanged(QString)), this, SLOT(filterObjects(QString)));
+  connect(ui->objList->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
+          this, SLOT(objectSelected()));
+
+  QShortcut *removeKey = new QShortcut(QKeySequence(QKeySequence::Delete), ui->objList);
+  removeKey->setContext(Qt::WidgetShortcut);
+  connect(removeKey, SIGNAL(activated()), this, SLOT(removeObject()));
+
+  // tree and list, their rows are made when they are shown
+  this->exeFunctions = new FunctionTreeModel(this);
+  this->exeSymbols = new SymbolListModel(this);
 
-  // tree
+  ui->exeFunctionsTree->setModel(this->exeFunctions);
+  ui->exeDataList->setModel(this->exeSymbols);
+  ui->exeFunctionsTree->setUniformRowHeights(true);
+  ui->exeDataList->setUniformItemSizes(true);
   ui->exeFunctionsTree->header()->hide();
-  ui->exeFunctionsTree->headerItem()->setText(0, "Offset");
+
+  connect(ui->exeFunctionsTree->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
+          this, SLOT(exeFunctionSelected()));
+  connect(ui->exeDataList->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
+          this, SLOT(exeSymbolSelected()));
 
   // output table
   ui->infoOutputTable->setColumnCount(2);
@@ -66,10 +106,62 @@ MainWindow::MainWindow(QWidget *parent) :
   new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_O), this, SLOT(on_addObj_clicked()));
   new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_R), this, SLOT(on_runProj_clicked()));
   new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_C), this, SLOT(on_clearProj_clicked()));
+  new QShortcut(QKeySequence(Qt::Key_Escape), this, SLOT(cancelAnalysis()));
+
+  // the tools have no buttons, the menu lists them with their keys; a
+  // key must not be given twice or Qt fires neither action
+  QMenu *tools = menuBar()->addMenu(tr("&Tools"));
+
+  tools->addAction(tr("Find objects in a build tree..."), this, SLOT(discoverObjects()),
+                   QKeySequence(Qt::CTRL + Qt::Key_D));
+  tools->addAction(tr("Set sysroot..."), this, SLOT(setSysroot()),
+                   QKeySequence(Qt::CTRL + Qt::Key_T));
+  tools->addSeparator();
+  tools->addAction(tr("Verify link"), this, SLOT(verifyLink()),
+                   QKeySequence(Qt::CTRL + Qt::Key_L));
+  tools->addAction(tr("Load linker map..."), this, SLOT(loadLinkerMap()),
+                   QKeySequence(Qt::CTRL + Qt::Key_M));
+  tools->addAction(tr("Show layout"), this, SLOT(showLayout()),
+                   QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_M));
+  tools->addAction(tr("Load profile..."), this, SLOT(loadProfile()),
+                   QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_L));
+  tools->addSeparator();
+  tools->addAction(tr("Executable bytes"), this, SLOT(viewExeBytes()),
+                   QKeySequence(Qt::CTRL + Qt::Key_H));
+  tools->addAction(tr("Object bytes"), this, SLOT(viewObjectBytes()),
+                   QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_H));
+  tools->addAction(tr("Code of the selected function"), this, SLOT(showCode()),
+                   QKeySequence(Qt::CTRL + Qt::Key_G));
+
+  // progress of a run, in the status bar while it goes
+  this->progressLabel = new QLabel(this);
+  this->progressBar = new QProgressBar(this);
+  this->cancelButton = new QPushButton(tr("Cancel"), this);
+
+  this->progressBar->setMaximumWidth(200);
+  this->cancelButton->setToolTip("Cancel the run (Esc)");
+
+  statusBar()->addWidget(this->progressLabel, 1);
+  statusBar()->addPermanentWidget(this->progressBar);
+  statusBar()->addPermanentWidget(this->cancelButton);
+
+  connect(this->cancelButton, SIGNAL(clicked()), this, SLOT(cancelAnalysis()));
+
+  this->drainTimer = new QTimer(this);
+  this->drainTimer->setInterval(DRAIN_INTERVAL);
+  connect(this->drainTimer, SIGNAL(timeout()), this, SLOT(drainFunctions()));
+
+  this->progressLabel->hide();
+  this->progressBar->hide();
+  this->cancelButton->hide();
 }
 
 MainWindow::~MainWindow()
 {
+  // a running analysis still uses the files
+  this->stopAnalysis();
+  this->stopSearch();
+
   delete ui;
 }
 
@@ -88,22 +180,246 @@ void MainWindow::on_addObj_clicked()
       if (filename == "")
         return;
 
-      QStringList tokens = filename.split("/");
-
       QDir CurrentDir;
       MySettings.setValue(DEFAULT_DIR_KEY, CurrentDir.absoluteFilePath(filename));
 
-      ELFFile *obj = new ELFFile(filename.toStdString());
-      this->objfiles.push_back(obj);
+      this->addObjectFile(filename);
+    }
+
+}
+
+void MainWindow::addObjectFile(QString filename)
+{
+  ELFFile *obj = new ELFFile(filename.toStdString());
+  int index = this->objfiles.size();
+
+  this->objfiles.push_back(obj);
+  this->objFunctions.push_back(std::vector<Function *>());
+
+  // the first object of a name is the one symbols lead to
+  this->fileIndex[obj] = index;
+  this->nameIndex.emplace(obj->getName(), index);
+
+  this->objNames->addEntries({SymbolListModel::Entry{obj->getName(), filename.toStdString()}});
+}
+
+// the object a symbol is defined in, or -1
+int MainWindow::objectIndex(const std::string &file) const
+{
+  auto it = this->nameIndex.find(file);
+
+  return (it == this->nameIndex.end()) ? -1 : it->second;
+}
+
+// makes the list and the indexes again after an object is removed
+void MainWindow::indexObjects()
+{
+  std::vector<SymbolListModel::Entry> names;
+
+  this->fileIndex.clear();
+  this->nameIndex.clear();
+
+  for (unsigned int i = 0; i < this->objfiles.size(); ++i)
+    {
+      ELFFile *E = this->objfiles[i];
+
+      this->fileIndex[E] = i;
+      this->nameIndex.emplace(E->getName(), i);
+      names.push_back(SymbolListModel::Entry{E->getName(), E->getPath()});
+    }
+
+  this->objNames->setEntries(names);
+
+  this->shownObject = -1;
+  this->objView->clear();
+  this->objView->hide();
+}
+
+void MainWindow::objectSelected()
+{
+  QModelIndexList selected = ui->objList->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  this->showObject(this->objFilterModel->mapToSource(selected[0]).row());
+}
+
+void MainWindow::filterObjects(QString text)
+{
+  this->objFilterModel->setFilterFixedString(text);
+}
+
+// objects can only be removed before the project is run, the analysis
+// keeps them from then on
+void MainWindow::removeObject()
+{
+  if (!ui->addObj->isEnabled())
+    return;
+
+  QModelIndexList selected = ui->objList->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  int index = this->objFilterModel->mapToSource(selected[0]).row();
+  ELFFile *E = this->objfiles[index];
+
+  this->objfiles.erase(this->objfiles.begin() + index);
+  this->objFunctions.erase(this->objFunctions.begin() + index);
+  delete E;
+
+  this->indexObjects();
+}
+
+// fills the detail view with an object, nothing is made for the objects
+// that are never looked at
+void MainWindow::showObject(int object)
+{
+  if (object == this->shownObject || object < 0 || object >= (int) this->objfiles.size())
+    return;
+
+  this->shownObject = object;
+
+  std::vector<SymbolListModel::Entry> data;
+
+  if (this->AB != nullptr && object < (int) this->objSymbols.size())
+    for (std::string S : this->objSymbols[object])
+      {
+        Symbol sym = this->AB->getSymbol(S);
+        if (sym.isUndefined() || sym.isVariable())
+          data.push_back(SymbolListModel::Entry{S, ""});
+      }
+
+  this->objView->setSymbols(data);
+  this->objView->setFunctions(this->functionEntries(this->objFunctions[object]));
+  this->objView->toggleHex(ui->checkHex->isChecked());
+  this->objView->show();
+}
+
+// selects an object in the list, clearing a filter that hides it
+void MainWindow::selectObject(int object)
+{
+  QModelIndex row = this->objFilterModel->mapFromSource(this->objNames->index(object));
+
+  if (!row.isValid())
+    {
+      ui->objFilter->clear();
+      row = this->objFilterModel->mapFromSource(this->objNames->index(object));
+    }
+
+  ui->objList->selectionModel()->select(row, QItemSelectionModel::ClearAndSelect);
+  ui->objList->scrollTo(row);
+
+  this->showObject(object);
+}
+
+// looks for the objects of the executable in a build tree on its own
+// thread; searchFinished adds them and runs the project
+void MainWindow::discoverObjects()
+{
+  if (this->exefile == nullptr || !ui->addObj->isEnabled() || this->search != nullptr)
+    return;
+
+  const QString BUILD_DIR_KEY("buildtree");
+  QSettings MySettings;
+  QString root = QFileDialog::getExistingDirectory(this, tr("Select the build tree"),
+                                                   MySettings.value(BUILD_DIR_KEY).toString());
+
+  if (root == "")
+    return;
+
+  MySettings.setValue(BUILD_DIR_KEY, root);
+
+  this->searchRoot = root;
+  this->search = new ObjectSearch(this->exefile->getPath(), root.toStdString());
+  this->searchThread = new QThread(this);
+  this->search->moveToThread(this->searchThread);
+
+  connect(this->searchThread, SIGNAL(started()), this->search, SLOT(run()));
+  connect(this->search, SIGNAL(progress(QString, QString, int, int)),
+          this, SLOT(analysisProgress(QString, QString, int, int)));
+  connect(this->search, SIGNAL(finished(int)), this, SLOT(searchFinished(int)));
+
+  ui->runProj->setDisabled(true);
+  ui->addObj->setDisabled(true);
+
+  this->progressLabel->setText("Scanning " + root);
+  this->progressBar->setRange(0, 0);
+  this->progressLabel->show();
+  this->progressBar->show();
+  this->cancelButton->setEnabled(true);
+  this->cancelButton->show();
+
+  this->searchThread->start();
+}
+
+void MainWindow::searchFinished(int outcome)
+{
+  this->searchThread->quit();
+  this->searchThread->wait();
+
+  std::vector<std::string> found = this->search->getFound();
+  size_t objects = this->search->getObjectCount();
+
+  delete this->search;
+  delete this->searchThread;
+  this->search = nullptr;
+  this->searchThread = nullptr;
+
+  this->progressLabel->hide();
+  this->progressBar->hide();
+  this->cancelButton->hide();
+
+  ui->runProj->setDisabled(false);
+  ui->addObj->setDisabled(false);
+
+  if (outcome == ANALYSIS_CANCELLED)
+    return;
+
+  if (found.empty())
+    {
+      QMessageBox::warning(this, tr("No object files found"),
+                           QString("None of the %1 ELF objects under %2 match the executable.")
+                           .arg(objects).arg(this->searchRoot));
+      return;
+    }
+
+  // the objects already in the project aren't added twice
+  std::unordered_set<std::string> added;
 
-      filename = tokens.value(tokens.length() - 1);
+  for (ELFFile *E : this->objfiles)
+    added.insert(QFileInfo(QString::fromStdString(E->getPath())).canonicalFilePath().toStdString());
 
-      QWidget *view = new objecttab();
-      obj->setView(view);
+  for (const std::string &path : found)
+    {
+      QString filename = QString::fromStdString(path);
 
-      ui->objTabs->insertTab(ui->objTabs->count(), view, QIcon(QString("")), filename);
+      if (added.insert(QFileInfo(filename).canonicalFilePath().toStdString()).second)
+        this->addObjectFile(filename);
     }
 
+  this->on_runProj_clicked();
+}
+
+// stops a search and waits for it, nothing it found is added
+void MainWindow::stopSearch()
+{
+  if (this->search == nullptr)
+    return;
+
+  this->search->cancel();
+  this->searchThread->quit();
+  this->searchThread->wait();
+
+  QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+
+  delete this->search;
+  delete this->searchThread;
+  this->search = nullptr;
+  this->searchThread = nullptr;
+
+  this->progressLabel->hide();
+  this->progressBar->hide();
+  this->cancelButton->hide();
 }
 
 void MainWindow::on_addExe_clicked()
@@ -125,74 +441,172 @@ void MainWindow::on_addExe_clicked()
   this->exefile = new ELFFile(filename.toStdString());
 
   ui->addExe->setDisabled(true);
-
-  this->exefile->setView(this);
 }
 
 void MainWindow::on_runProj_clicked()
 {
-  if (!ui->runProj->isEnabled())
+  if (!ui->runProj->isEnabled() || this->analysis != nullptr)
     return;
 
-  int errCount = 0, errCode;
   QString errors;
 
-  if (this->exefile)
-    {
-      errCode = this->exefile->initBfd(ELF_EXE_FILE);
+  if (this->exefile == nullptr)
+    errors += "Can't find executable file!\n";
 
-      if (errCode)
-        {
-          errCount++;
-          errors += this->errorMessage(errCode, this->exefile);
-        }
-    }
-  else
+  if (this->objfiles.empty())
+    errors += "Can't find any object file!";
+
+  if (!errors.isEmpty())
     {
-      errCount++;
-      errors += "Can't find executable file!\n";
+      QMessageBox::critical(this, tr("Errors parsing project"), errors);
+      return;
     }
 
-  if (this->objfiles.size())
-    {
-      for (ELFFile *E : this->objfiles)
-        {
-          errCode = E->initBfd(ELF_OBJ_FILE);
+  // what the objects don't define comes from the needed libraries
+  const QString SYSROOT_KEY("sysroot");
+  QSettings MySettings;
+  std::string sysroot = MySettings.value(SYSROOT_KEY, "/").toString().toStdString();
 
-          if (errCode)
-            {
-              errCount++;
-              errors += this->errorMessage(errCode, E);
-            }
-        }
-    }
+  // the files are only touched by the analysis thread until it's done
+  this->analysis = new ProjectAnalysis(this->exefile, this->objfiles, sysroot);
+  this->analysisThread = new QThread(this);
+  this->analysis->moveToThread(this->analysisThread);
+
+  connect(this->analysisThread, SIGNAL(started()), this->analysis, SLOT(run()));
+  connect(this->analysis, SIGNAL(progress(QString, QString, int, int)),
+          this, SLOT(analysisProgress(QString, QString, int, int)));
+  connect(this->analysis, SIGNAL(bindingReady()), this, SLOT(bindingReady()));
+  connect(this->analysis, SIGNAL(finished(int)), this, SLOT(analysisFinished(int)));
+
+  ui->runProj->setDisabled(true);
+  ui->addObj->setDisabled(true);
+
+  // the viewer would wait on bfd until the run is over
+  if (this->codeViewer)
+    this->codeViewer->setDisabled(true);
+
+  this->progressLabel->setText("Starting");
+  this->progressBar->setRange(0, 0);
+  this->progressLabel->show();
+  this->progressBar->show();
+  this->cancelButton->setEnabled(true);
+  this->cancelButton->show();
+
+  this->analysisThread->start();
+  this->drainTimer->start();
+}
+
+// stops the run, or the search for objects, whichever is going
+void MainWindow::cancelAnalysis()
+{
+  if (this->analysis != nullptr)
+    this->analysis->cancel();
+  else if (this->search != nullptr)
+    this->search->cancel();
   else
-    {
-      errCount++;
-      errors += "Can't find any object file!";
-    }
+    return;
 
-  if (errCount)
+  this->cancelButton->setDisabled(true);
+  this->progressLabel->setText("Cancelling");
+}
+
+void MainWindow::analysisProgress(QString phase, QString file, int done, int total)
+{
+  if (file.isEmpty())
+    this->progressLabel->setText(phase);
+  else
+    this->progressLabel->setText(QString("%1 %2 (%3/%4)").arg(phase).arg(file).arg(done + 1).arg(total));
+
+  this->progressBar->setRange(0, total);
+  this->progressBar->setValue(done);
+}
+
+// the data symbols can be shown before any file is disassembled
+void MainWindow::bindingReady()
+{
+  this->AB = this->analysis->getBinding();
+  this->showDataSymbols();
+}
+
+void MainWindow::drainFunctions()
+{
+  this->showFunctions(MAX_DRAINED);
+}
+
+void MainWindow::analysisFinished(int outcome)
+{
+  this->analysisThread->quit();
+  this->analysisThread->wait();
+
+  if (this->codeViewer)
+    this->codeViewer->setDisabled(false);
+
+  // whatever is left in the channel goes in at once
+  this->drainTimer->stop();
+  this->showFunctions(this->analysis->getChannel()->pending());
+
+  if (outcome == ANALYSIS_FAILED)
     {
+      QString errors;
+
+      for (auto &E : this->analysis->getErrors())
+        errors += this->errorMessage(E.second, E.first);
+
       QMessageBox::critical(this, tr("Errors parsing project"), errors);
-      return;
+
+      ui->runProj->setDisabled(false);
+      ui->addObj->setDisabled(false);
     }
+  else if (outcome == ANALYSIS_DONE)
+    this->FD = this->analysis->getDiff();
 
-  this->AB = new AddressBinding(objfiles, exefile);
+  delete this->analysis;
+  delete this->analysisThread;
+  this->analysis = nullptr;
+  this->analysisThread = nullptr;
 
-  Disassembly::add_section(".text");
-  Disassembly::disassemble_data(exefile);
-  for (ELFFile *E : this->objfiles)
-    Disassembly::disassemble_data(E);
+  this->progressLabel->hide();
+  this->progressBar->hide();
+  this->cancelButton->hide();
+}
 
-  ui->runProj->setDisabled(true);
-  ui->addObj->setDisabled(true);
+// stops a run and waits for it, dropping the results still on their way
+void MainWindow::stopAnalysis()
+{
+  if (this->analysis == nullptr)
+    return;
+
+  this->drainTimer->stop();
+  this->analysis->cancel();
+  this->analysisThread->quit();
+  this->analysisThread->wait();
+
+  QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+
+  // the binding may have been made without the window hearing of it
+  if (this->AB == nullptr)
+    this->AB = this->analysis->getBinding();
+  if (this->FD == nullptr)
+    this->FD = this->analysis->getDiff();
 
-  this->showSymbols();
+  delete this->analysis;
+  delete this->analysisThread;
+  this->analysis = nullptr;
+  this->analysisThread = nullptr;
+
+  if (this->codeViewer)
+    this->codeViewer->setDisabled(false);
+
+  this->progressLabel->hide();
+  this->progressBar->hide();
+  this->cancelButton->hide();
 }
 
 void MainWindow::on_clearProj_clicked()
 {
+  this->stopAnalysis();
+  this->stopSearch();
+
   if (this->exefile)
     {
       delete this->exefile;
@@ -212,16 +626,38 @@ void MainWindow::on_clearProj_clicked()
       this->AB = nullptr;
     }
 
-  int tabsNo = ui->objTabs->count();
-  for (int i = 0; i < tabsNo; ++i)
+  if (this->FD)
+    {
+      delete this->FD;
+      this->FD = nullptr;
+    }
+
+  if (this->LM)
     {
-      ui->objTabs->removeTab(0);
+      delete this->LM;
+      this->LM = nullptr;
     }
 
-  ui->exeDataList->reset();
-  ui->exeFunctionsTree->reset();
-  ui->exeDataList->clear();
-  ui->exeFunctionsTree->clear();
+  if (this->layoutView)
+    {
+      this->layoutView->setIndex(nullptr);
+      this->layoutView->hide();
+    }
+
+  if (this->codeViewer)
+    this->codeViewer->hide();
+
+  this->objSymbols.clear();
+  this->objFunctions.clear();
+  this->indexObjects();
+
+  this->diffFunction = nullptr;
+  this->lineDiffs.clear();
+  this->diffByExeLine.clear();
+  ui->objFilter->clear();
+
+  this->exeSymbols->clear();
+  this->exeFunctions->clear();
   this->removeTableRows();
 
   ui->addExe->setDisabled(false);
@@ -231,92 +667,97 @@ void MainWindow::on_clearProj_clicked()
   ui->exeFunctionsTree->header()->hide();
 }
 
-void MainWindow::on_objTabs_tabCloseRequested(int index)
-{
-  ELFFile *E = this->objfiles[index];
-
-  this->objfiles.erase(this->objfiles.begin() + index);
-  delete E;
-
-  ui->objTabs->removeTab(index);
-}
-
-void MainWindow::initFunctionTree(ELFFile *E, QTreeWidget *parent) const
+// a row for every disassembled function the binding knows
+std::vector<FunctionTreeModel::Entry> MainWindow::functionEntries(const std::vector<Function *> &functions) const
 {
-  parent->setColumnCount(3);
-  parent->setColumnWidth(0, 150);
-  parent->headerItem()->setText(1, "Instruction");
+  std::vector<FunctionTreeModel::Entry> entries;
 
-  parent->setColumnHidden(2, true);
-  parent->headerItem()->setText(2, "Opcode");
-
-  parent->header()->show();
-
-  for (Function *f : E->getFunctions())
+  for (Function *f : functions)
     {
       if (this->AB->getSymbol(f->getName()).isEmpty())
         continue;
 
-      QTreeWidgetItem *itm = new QTreeWidgetItem(parent);
-
-      itm->setText(0, QString::fromStdString(f->getName()));
-      ui->exeFunctionsTree->addTopLevelItem(itm);
-
-      this->addCodeLines(f, itm);
+      entries.push_back(FunctionTreeModel::Entry{f->getName(), f, ""});
     }
-}
-
-void MainWindow::addCodeLines(Function *f, QTreeWidgetItem *parent) const
-{
-  for (CodeLine *c : f->getCodeLines())
-    {
-      QTreeWidgetItem *itm = new QTreeWidgetItem(parent);
-
-      itm->setText(0, QString::fromStdString(c->getAddress()));
-      itm->setText(1, QString::fromStdString(c->getLine()));
-      itm->setText(2, QString::fromStdString(c->getHexValue()));
 
-      parent->addChild(itm);
-    }
+  return entries;
 }
 
-void MainWindow::showSymbols() const
+void MainWindow::showDataSymbols()
 {
   std::vector<std::string> symbols = this->AB->getSymbols();
+  std::vector<FunctionTreeModel::Entry> functions;
+  std::vector<SymbolListModel::Entry> data;
 
   // exe file gets the symbols directly from the address binding module
   // so it can easily ignore useless symbols
-  initFunctionTree(this->exefile, ui->exeFunctionsTree);
   for (std::string S : symbols)
     {
       Symbol sym = this->AB->getSymbol(S);
+
       if (sym.isUndefined() || sym.isVariable())
-        ui->exeDataList->addItem(QString::fromStdString(S));
+        data.push_back(SymbolListModel::Entry{S, sym.provided_by});
 
       if (sym.isFunction() && sym.isUndefined())
-        {
-          QTreeWidgetItem *itm = new QTreeWidgetItem(ui->exeFunctionsTree);
-
-          itm->setText(0, QString::fromStdString(sym.name));
-          ui->exeFunctionsTree->addTopLevelItem(itm);
-        }
+        functions.push_back(FunctionTreeModel::Entry{sym.name, nullptr, sym.provided_by});
     }
 
-  for (unsigned int i = 0; i < this->objfiles.size(); ++i)
-    {
-      symbols.clear();
-      symbols = this->objfiles[i]->getSymbolList();
+  this->exeSymbols->setEntries(data);
+  this->exeFunctions->setEntries(functions);
+  this->exeShown = 0;
+
+  ui->exeFunctionsTree->setColumnWidth(0, 150);
+  ui->exeFunctionsTree->setColumnHidden(2, true);
+  ui->exeFunctionsTree->header()->show();
+
+  // the objects' symbols are only sorted out when one is shown
+  this->objSymbols = this->analysis->getSymbolLists();
 
-      objecttab* tui = (objecttab *) ui->objTabs->widget(i);
+  int shown = this->shownObject;
 
-      initFunctionTree(this->objfiles[i], tui->getTree());
+  this->shownObject = -1;
+  this->showObject(shown);
+}
 
-      for (std::string S : symbols)
+// moves at most *max* of the disassembled functions into the models, the
+// ones of a file that come in a row are added together
+void MainWindow::showFunctions(size_t max)
+{
+  if (this->analysis == nullptr || this->AB == nullptr)
+    return;
+
+  std::vector<FunctionChannel::Item> items = this->analysis->getChannel()->take(max);
+  size_t i = 0;
+
+  while (i < items.size())
+    {
+      ELFFile *E = items[i].file;
+      std::vector<Function *> functions;
+
+      for (; i < items.size() && items[i].file == E; ++i)
+        functions.push_back(items[i].function);
+
+      if (E == this->exefile)
         {
-          Symbol sym = this->AB->getSymbol(S);
-          if (sym.isUndefined() || sym.isVariable())
-            tui->addSymbol(S);
+          // the library functions listed with the symbols stay at the end
+          std::vector<FunctionTreeModel::Entry> entries = this->functionEntries(functions);
+          int count = entries.size();
+
+          this->exeFunctions->insertEntries(this->exeShown, entries);
+          this->exeShown += count;
+          continue;
         }
+
+      auto it = this->fileIndex.find(E);
+      if (it == this->fileIndex.end())
+        continue;
+
+      std::vector<Function *> &shown = this->objFunctions[it->second];
+      shown.insert(shown.end(), functions.begin(), functions.end());
+
+      // only the object in view gets rows now
+      if (it->second == this->shownObject)
+        this->objView->addFunctions(this->functionEntries(functions));
     }
 }
 
@@ -383,91 +824,361 @@ void MainWindow::on_checkHex_clicked(bool checked)
   ui->exeFunctionsTree->setColumnHidden(1, checked);
   ui->exeFunctionsTree->setColumnHidden(2, !checked);
 
-  for (ELFFile *E : this->objfiles)
-    ((objecttab *)E->getView())->toggleHex(checked);
+  this->objView->toggleHex(checked);
 }
 
 
-void MainWindow::on_exeFunctionsTree_itemSelectionChanged()
+void MainWindow::exeFunctionSelected()
 {
-  QModelIndex idx = ui->exeFunctionsTree->selectionModel()->selectedIndexes()[0];
-  QTreeWidgetItem *item = (QTreeWidgetItem *)idx.internalPointer();
-  QTreeWidgetItem *parent = item->parent();
-  QString symbolName = (parent == nullptr) ? item->text(0) : parent->text(0);
-  Symbol sym = AB->getSymbol(symbolName.toStdString());
+  QModelIndexList selected = ui->exeFunctionsTree->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  QModelIndex idx = selected[0];
+  QModelIndex parent = idx.parent();
+  int functionRow = parent.isValid() ? parent.row() : idx.row();
+  const FunctionTreeModel::Entry &entry = this->exeFunctions->entry(functionRow);
+  QString symbolName = QString::fromStdString(entry.name);
+  Symbol sym = AB->getSymbol(entry.name);
+
+  if (sym.isUndefined())
+    return;
+
+  int i = this->objectIndex(sym.defined_in);
+  if (i < 0)
+    return;
 
-  if (!sym.isUndefined())
+  objecttab *ot = this->objView;
+  this->selectObject(i);
+
+  // lines are paired by their offset in the function,
+  // not by their row
+  if (entry.function != nullptr)
+    this->compareFunction(entry.function, i, sym.name);
+
+  if (!parent.isValid())
     {
-      std::string filename = sym.defined_in;
+      ot->selectFunction(symbolName);
+      this->removeTableRows();
+      this->addRows(sym.dumpExeData(), sym.dumpObjData());
+      this->addMapRow(sym.exe_vma);
+      return;
+    }
 
-      for (unsigned int i = 0; i < this->objfiles.size(); ++i)
-        {
-          if (this->objfiles[i]->getName().compare(filename) == 0)
-            {
-              objecttab *ot = (objecttab *)this->objfiles[i]->getView();
-              ui->objTabs->setCurrentIndex(i);
-
-              if (parent == nullptr)
-                {
-                  ot->selectFunction(symbolName);
-                  this->removeTableRows();
-                  this->addRows(sym.dumpExeData(), sym.dumpObjData());
-                }
-              else
-                {
-                  unsigned int itemAt = ui->exeFunctionsTree->currentIndex().row();
-                  std::vector<Function *> exeFuncs = this->exefile->getFunctions();
-                  auto exeIt = find_if(exeFuncs.begin(), exeFuncs.end(),
-                                       [&sym](Function *F) {return F->getName().compare(sym.name) == 0;});
-
-                  std::vector<Function *> objFuncs = this->objfiles[i]->getFunctions();
-                  auto objIt = find_if(objFuncs.begin(), objFuncs.end(),
-                                       [&sym](Function *F) {return F->getName().compare(sym.name) == 0;});
-
-                  this->removeTableRows();
-
-                  if (exeIt != exeFuncs.end())
-                    {
-                      std::vector<CodeLine *> c1 = (*exeIt)->getCodeLines();
-                      std::vector<CodeLine *> c2 = (*objIt)->getCodeLines();
-
-                      if (itemAt >= c2.size())
-                        {
-                          this->addRows(c1[itemAt]->dumpData(), "");
-                        }
-                      else {
-                          ot->selectFunctionLine(symbolName, itemAt);
-                          this->addRows(c1[itemAt]->dumpData(), c2[itemAt]->dumpData());
-                        }
-
-                    }
-                }
-
-              break;
-            }
-        }
+  // both functions come straight from the models
+  int itemAt = idx.row();
+  Function *exeFunction = entry.function;
+  Function *objFunction = ot->getFunction(sym.name);
+
+  this->removeTableRows();
+
+  if (exeFunction == nullptr)
+    return;
+
+  const CodeLine *c1 = exeFunction->getCodeLine(itemAt);
+  const LineDiff *lineIt = nullptr;
+
+  if (this->diffFunction == exeFunction && itemAt >= 0
+      && itemAt < (int) this->diffByExeLine.size() && this->diffByExeLine[itemAt] >= 0)
+    lineIt = &this->lineDiffs[this->diffByExeLine[itemAt]];
+
+  if (lineIt == nullptr || lineIt->objLine < 0 || objFunction == nullptr)
+    {
+      this->addRows(c1->dumpData(), "");
     }
+  else {
+      const CodeLine *c2 = objFunction->getCodeLine(lineIt->objLine);
+
+      ot->selectFunctionLine(symbolName, lineIt->objLine);
+      this->addRows(c1->dumpData(), c2->dumpData());
+    }
+
+  if (lineIt != nullptr)
+    this->addRows(FunctionDiff::statusName(lineIt->status), "");
+
+  this->addMapRow(c1->getVma());
 }
 
-void MainWindow::on_exeDataList_itemSelectionChanged()
+// compares a function with its object once, the clicks on its lines
+// only look the pair up
+void MainWindow::compareFunction(Function *exeFunction, int object, const std::string &name)
 {
-  QModelIndex index = ui->exeDataList->selectionModel()->selectedIndexes()[0];
-  QString symbolName = ui->exeDataList->item(index.row())->text();
-  Symbol sym = AB->getSymbol(symbolName.toStdString());
+  if (this->FD == nullptr || exeFunction == this->diffFunction)
+    return;
 
-  std::string filename = sym.defined_in;
+  this->lineDiffs = this->FD->compare(this->objfiles[object], name);
+  this->diffByExeLine.assign(exeFunction->getCodeLineCount(), -1);
 
-  for (unsigned int i = 0; i < this->objfiles.size(); ++i)
+  for (size_t k = 0; k < this->lineDiffs.size(); ++k)
     {
-      if (this->objfiles[i]->getName().compare(filename) == 0)
-        {
-          objecttab *ot = (objecttab *)this->objfiles[i]->getView();
-          ui->objTabs->setCurrentIndex(i);
-          ot->selectSymbol(symbolName);
-          break;
-        }
+      int line = this->lineDiffs[k].exeLine;
+
+      if (line >= 0 && line < (int) this->diffByExeLine.size())
+        this->diffByExeLine[line] = k;
+    }
+
+  this->diffFunction = exeFunction;
+}
+
+void MainWindow::exeSymbolSelected()
+{
+  QModelIndexList selected = ui->exeDataList->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  QString symbolName = QString::fromStdString(this->exeSymbols->entry(selected[0].row()).name);
+  Symbol sym = AB->getSymbol(symbolName.toStdString());
+
+  int i = this->objectIndex(sym.defined_in);
+  if (i >= 0)
+    {
+      this->selectObject(i);
+      this->objView->selectSymbol(symbolName);
     }
 
   this->removeTableRows();
   this->addRows(sym.dumpExeData(), sym.dumpObjData());
+
+  if (sym.placed)
+    this->addMapRow(sym.exe_vma);
+}
+
+void MainWindow::viewExeBytes()
+{
+  this->viewBytes(this->exefile);
+}
+
+void MainWindow::viewObjectBytes()
+{
+  if (this->shownObject >= 0)
+    this->viewBytes(this->objfiles[this->shownObject]);
+}
+
+// shows the sections of a file in the hex viewer, which maps the file on
+// its own so it doesn't need the analysis
+void MainWindow::viewBytes(ELFFile *E)
+{
+  if (E == nullptr)
+    return;
+
+  if (this->hexViewer == nullptr)
+    this->hexViewer = new HexViewer(this);
+
+  if (!this->hexViewer->open(QString::fromStdString(E->getPath())))
+    {
+      QMessageBox::critical(this, tr("Errors opening file"),
+                            QString::fromStdString(E->getPath()) + " isn't an ELF file.");
+      return;
+    }
+
+  this->hexViewer->show();
+  this->hexViewer->raise();
+}
+
+// draws where the functions of the executable are, once they are bound
+void MainWindow::showLayout()
+{
+  if (this->AB == nullptr)
+    return;
+
+  std::shared_ptr<LayoutIndex> index = std::make_shared<LayoutIndex>();
+  index->build(*this->AB);
+
+  if (this->layoutView == nullptr)
+    this->layoutView = new LayoutView(this);
+
+  this->layoutView->setIndex(index);
+  this->layoutView->show();
+  this->layoutView->raise();
+}
+
+// colors the layout by the weights of a profile
+void MainWindow::loadProfile()
+{
+  if (this->AB == nullptr)
+    return;
+
+  const QString PROFILE_DIR_KEY("/profile");
+  QSettings MySettings;
+  QString filename = QFileDialog::getOpenFileName(this, tr("Load profile"),
+                                                  MySettings.value(PROFILE_DIR_KEY).toString());
+
+  if (filename == "")
+    return;
+
+  MySettings.setValue(PROFILE_DIR_KEY, filename);
+
+  // a new index, the tiles being drawn still read the old one
+  std::shared_ptr<LayoutIndex> index = std::make_shared<LayoutIndex>();
+  index->build(*this->AB);
+
+  if (!index->loadHotness(filename.toStdString()))
+    {
+      QMessageBox::critical(this, tr("Errors loading profile"), "Can't read " + filename + ".");
+      return;
+    }
+
+  if (this->layoutView == nullptr)
+    this->layoutView = new LayoutView(this);
+
+  this->layoutView->setIndex(index);
+  this->layoutView->setOverlay(LAYOUT_HEAT);
+  this->layoutView->show();
+  this->layoutView->raise();
+}
+
+// shows the code around the selected function of the executable, or
+// lets an address be typed in; only that much is disassembled
+void MainWindow::showCode()
+{
+  if (this->exefile == nullptr || this->analysis != nullptr)
+    return;
+
+  if (this->codeViewer == nullptr)
+    this->codeViewer = new CodeViewer(this);
+
+  if (!this->codeViewer->open(QString::fromStdString(this->exefile->getPath())))
+    {
+      QMessageBox::critical(this, tr("Errors opening file"),
+                            QString::fromStdString(this->exefile->getPath()) + " cannot be parsed.");
+      return;
+    }
+
+  QModelIndexList selected = ui->exeFunctionsTree->selectionModel()->selectedIndexes();
+
+  if (!selected.isEmpty() && this->AB != nullptr)
+    {
+      QModelIndex idx = selected[0];
+      int functionRow = idx.parent().isValid() ? idx.parent().row() : idx.row();
+      Symbol sym = this->AB->getSymbol(this->exeFunctions->entry(functionRow).name);
+
+      if (sym.placed)
+        this->codeViewer->showAt(sym.exe_vma);
+    }
+
+  this->codeViewer->show();
+  this->codeViewer->raise();
+}
+
+// names the input section an address of the executable comes from,
+// when a linker map is loaded
+void MainWindow::addMapRow(bfd_vma vma)
+{
+  if (this->LM == nullptr)
+    return;
+
+  const MapSection *S = this->LM->attribute(vma);
+  if (S != NULL)
+    this->addRows("Input section: " + this->LM->describe(S), "");
+}
+
+// reads a -Map file of the link and checks it against the binding
+void MainWindow::loadLinkerMap()
+{
+  if (this->AB == nullptr)
+    return;
+
+  const QString MAP_DIR_KEY("/map");
+  QSettings MySettings;
+  QString filename = QFileDialog::getOpenFileName(this, tr("Load linker map"),
+                                                  MySettings.value(MAP_DIR_KEY).toString());
+
+  if (filename == "")
+    return;
+
+  MySettings.setValue(MAP_DIR_KEY, filename);
+
+  // only the symbols the binding knows are kept from the map
+  std::vector<std::string> names = this->AB->getSymbols();
+  std::unordered_set<std::string> wanted(names.begin(), names.end());
+
+  if (this->LM)
+    delete this->LM;
+
+  this->LM = new LinkerMap();
+
+  if (!this->LM->load(filename.toStdString(), &wanted))
+    {
+      QMessageBox::critical(this, tr("Errors parsing linker map"),
+                            filename + " isn't a GNU ld, gold or lld map file.");
+      delete this->LM;
+      this->LM = nullptr;
+      return;
+    }
+
+  const size_t MAX_SHOWN = 100;
+  char buf[160];
+  size_t checked = 0;
+  std::vector<MapMismatch> mismatches = this->LM->check(*this->AB, &checked);
+
+  this->removeTableRows();
+
+  snprintf(buf, sizeof(buf), "%zu input sections, %zu symbols",
+           this->LM->getSectionCount(), this->LM->getSymbolCount());
+  this->addRows("Linker map", buf);
+
+  snprintf(buf, sizeof(buf), "%zu checked, %zu mismatches", checked, mismatches.size());
+  this->addRows("Placement", buf);
+
+  for (size_t i = 0; i < mismatches.size() && i < MAX_SHOWN; ++i)
+    {
+      const MapMismatch &M = mismatches[i];
+
+      snprintf(buf, sizeof(buf), "%s: map 0x%llx, executable 0x%llx",
+               M.bySymbol ? "symbol" : "section", (unsigned long long) M.expected,
+               (unsigned long long) M.found);
+      this->addRows("  " + M.symbol + " (" + M.file + " " + M.section + ")", buf);
+    }
+}
+
+// picks the directory the needed libraries are looked up in
+void MainWindow::setSysroot()
+{
+  const QString SYSROOT_KEY("sysroot");
+  QSettings MySettings;
+  QString dir = QFileDialog::getExistingDirectory(this, tr("Select the sysroot of the executable"),
+                                                  MySettings.value(SYSROOT_KEY, "/").toString());
+
+  if (dir == "")
+    return;
+
+  MySettings.setValue(SYSROOT_KEY, dir);
+}
+
+// checks every relocation of the objects against the executable
+// and lists the results by relocation type
+void MainWindow::verifyLink()
+{
+  // the files are only read by the analysis while it runs
+  if (this->AB == nullptr || this->analysis != nullptr)
+    return;
+
+  const size_t MAX_SHOWN = 100;
+  char buf[160];
+
+  LinkVerifier V(this->objfiles, this->exefile, this->AB);
+  std::vector<RelocTypeReport> reports = V.verify();
+
+  this->removeTableRows();
+
+  for (const RelocTypeReport &R : reports)
+    {
+      snprintf(buf, sizeof(buf), "%zu checked, %zu mismatches, %zu not checked",
+               R.checked, R.mismatches.size(), R.skipped);
+      this->addRows(R.type, buf);
+
+      for (size_t i = 0; i < R.mismatches.size() && i < MAX_SHOWN; ++i)
+        {
+          const RelocMismatch &M = R.mismatches[i];
+          std::string where = "  " + M.file + " " + M.section + "+";
+
+          snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long) M.offset);
+          where += buf;
+
+          snprintf(buf, sizeof(buf), "%s: expected 0x%llx, found 0x%llx at 0x%llx",
+                   M.symbol.c_str(), (unsigned long long) M.expected,
+                   (unsigned long long) M.found, (unsigned long long) M.address);
+          this->addRows(where, buf);
+        }
+    }
 }
@@ -2,16 +2,32 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
 #include <QTableWidget>
+#include <QThread>
+#include <QTimer>
+#include <QProgressBar>
+#include <QLabel>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
 #include <vector>
+#include <unordered_map>
 #include <addressbinding.h>
+#include <functiontreemodel.h>
+#include <symbollistmodel.h>
+#include <functiondiff.h>
+#include <linkermap.h>
+#include <projectanalysis.h>
+#include <objectsearch.h>
+#include <hexviewer.h>
+#include <layoutview.h>
+#include <codeviewer.h>
 
 namespace Ui {
   class MainWindow;
 }
 
+class objecttab;
+
 class MainWindow : public QMainWindow
 {
   Q_OBJECT
@@ -29,20 +45,64 @@ private slots:
 
   void on_clearProj_clicked();
 
-  void on_objTabs_tabCloseRequested(int index);
-
   void on_checkHex_clicked(bool checked);
 
-  void on_exeFunctionsTree_itemSelectionChanged();
+  void exeFunctionSelected();
+
+  void exeSymbolSelected();
+
+  void verifyLink();
+
+  void setSysroot();
+
+  void discoverObjects();
+
+  void searchFinished(int outcome);
+
+  void loadLinkerMap();
+
+  void cancelAnalysis();
+
+  void analysisProgress(QString phase, QString file, int done, int total);
+
+  void bindingReady();
+
+  void drainFunctions();
+
+  void analysisFinished(int outcome);
+
+  void objectSelected();
+
+  void filterObjects(QString text);
+
+  void removeObject();
+
+  void viewExeBytes();
+
+  void viewObjectBytes();
+
+  void showLayout();
+
+  void loadProfile();
 
-  void on_exeDataList_itemSelectionChanged();
+  void showCode();
 
 private:
-  void showSymbols() const;
-  void initFunctionTree(ELFFile *E, QTreeWidget *parent) const;
-  void addCodeLines(Function *f, QTreeWidgetItem *parent) const;
+  void addObjectFile(QString filename);
+  void showDataSymbols();
+  void showFunctions(size_t max);
+  void stopAnalysis();
+  void stopSearch();
+  void viewBytes(ELFFile *E);
+  void showObject(int object);
+  void selectObject(int object);
+  void indexObjects();
+  int objectIndex(const std::string &file) const;
+  std::vector<FunctionTreeModel::Entry> functionEntries(const std::vector<Function *> &functions) const;
   void addRows(std::string info1, std::string info2);
+  void addMapRow(bfd_vma vma);
   void removeTableRows();
+  void compareFunction(Function *exeFunction, int object, const std::string &name);
   QString errorMessage(int errCode, ELFFile *E) const;
 
   Ui::MainWindow *ui;
@@ -51,6 +111,53 @@ private:
   std::vector<ELFFile *> objfiles;
 
   AddressBinding *AB = nullptr;
+  FunctionDiff *FD = nullptr;
+
+  // the diff of the executable function last selected and, by its line,
+  // the index of every pair in it or -1; its lines are compared once
+  Function *diffFunction = nullptr;
+  std::vector<LineDiff> lineDiffs;
+  std::vector<int> diffByExeLine;
+
+  FunctionTreeModel *exeFunctions;
+  SymbolListModel *exeSymbols;
+
+  // the run in progress, if any
+  ProjectAnalysis *analysis = nullptr;
+  QThread *analysisThread = nullptr;
+
+  // the build tree being searched for objects, if any
+  ObjectSearch *search = nullptr;
+  QThread *searchThread = nullptr;
+  QString searchRoot;
+
+  // the objects are browsed through a filtered list of names, a single
+  // view shows the selected one and its rows are made when it's selected
+  SymbolListModel *objNames;
+  QSortFilterProxyModel *objFilterModel;
+  objecttab *objView;
+  int shownObject = -1;
+
+  // what that view is made from, by object
+  std::vector<std::vector<std::string> > objSymbols;
+  std::vector<std::vector<Function *> > objFunctions;
+
+  // the index of every object, by file and by name
+  std::unordered_map<ELFFile *, int> fileIndex;
+  std::unordered_map<std::string, int> nameIndex;
+
+  // takes the disassembled functions into the models while it runs
+  QTimer *drainTimer;
+  int exeShown = 0;
+
+  QProgressBar *progressBar;
+  QLabel *progressLabel;
+  QPushButton *cancelButton;
+  LinkerMap *LM = nullptr;
+
+  HexViewer *hexViewer = nullptr;
+  LayoutView *layoutView = nullptr;
+  CodeViewer *codeViewer = nullptr;
 };
 
 #endif // MAINWINDOW_H
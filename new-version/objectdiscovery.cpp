@@ -0,0 +1,359 @@
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "objectdiscovery.h"
+#include "analysisrun.h"
+#include "elfbytes.h"
+#include "tools.h"
+#include "elf/common.h"
+#include "elf/external.h"
+#include "elf/internal.h"
+
+// how many files are read between two progress reports
+const size_t REPORT_EVERY = 256;
+
+std::vector<std::string> ObjectDiscovery::discover(const std::string &exe, const std::string &root,
+                                                   AnalysisListener *L,
+                                                   const std::atomic<bool> *cancel)
+{
+  std::vector<std::string> result;
+  AnalysisListener quiet;
+
+  if (L == nullptr)
+    L = &quiet;
+
+  auto stopped = [cancel]() { return cancel != nullptr && cancel->load(); };
+
+  this->scanned = 0;
+  this->objects = 0;
+  this->cancelled = false;
+  this->uncovered.clear();
+
+  std::vector<Definition> exeDefs;
+  if (!readFile(exe, false, exeDefs))
+    return result;
+
+  std::unordered_map<std::string, uint64_t> exeSyms;
+  for (const Definition &D : exeDefs)
+    exeSyms.emplace(D.name, D.size);
+
+  std::vector<std::string> files;
+
+  L->progress("Scanning " + root, "", 0, 0);
+  walk(root, files, cancel);
+  this->scanned = files.size();
+
+  std::vector<std::vector<Definition> > defs(files.size());
+  std::vector<char> isObject(files.size(), 0);
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> done(0);
+  size_t threads = worker_count(files.size());
+
+  // only the calling thread reports, the listener expects it
+  auto worker = [&](bool report)
+    {
+      for (size_t k = next++; k < files.size() && !stopped(); k = next++)
+        {
+          isObject[k] = readFile(files[k], true, defs[k]);
+
+          size_t count = ++done;
+
+          if (report && count % REPORT_EVERY == 0)
+            L->progress("Reading the files", "", count, files.size());
+        }
+    };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t = 1; t < threads; ++t)
+    workers.push_back(std::thread(worker, false));
+
+  if (threads)
+    worker(true);
+
+  for (std::thread &t : workers)
+    t.join();
+
+  if (stopped())
+    {
+      this->cancelled = true;
+      return result;
+    }
+
+  L->progress("Matching the objects", "", files.size(), files.size());
+
+  // the index only keeps names the executable defines, and is filled in
+  // file order so the choice doesn't depend on the threads
+  std::unordered_map<std::string, std::vector<Owner> > index;
+  std::vector<size_t> matched(files.size(), 0);
+  std::vector<char> conflict(files.size(), 0);
+
+  for (size_t k = 0; k < files.size(); ++k)
+    {
+      if (!isObject[k])
+        continue;
+
+      ++this->objects;
+
+      for (const Definition &D : defs[k])
+        {
+          auto it = exeSyms.find(D.name);
+
+          // not linked in, or dropped by --gc-sections
+          if (it == exeSyms.end())
+            continue;
+
+          // a different build of the symbol, the object wasn't linked;
+          // a weak or unique one may just have lost to another definition
+          if (it->second != D.size)
+            {
+              if (D.bind == STB_GLOBAL)
+                conflict[k] = 1;
+              continue;
+            }
+
+          ++matched[k];
+          index[D.name].push_back(Owner{k, D.size});
+        }
+
+      std::vector<Definition>().swap(defs[k]);
+    }
+
+  auto candidate = [&](size_t k) { return matched[k] > 0 && !conflict[k]; };
+  std::vector<char> selected(files.size(), 0);
+
+  // a name only one candidate defines settles that object
+  for (auto it = index.begin(); it != index.end(); ++it)
+    {
+      size_t count = 0, last = 0;
+
+      for (const Owner &O : it->second)
+        if (candidate(O.object))
+          {
+            ++count;
+            last = O.object;
+          }
+
+      if (count == 1)
+        selected[last] = 1;
+    }
+
+  // the names left go to the candidate matching the executable best
+  for (const Definition &D : exeDefs)
+    {
+      auto it = index.find(D.name);
+      bool covered = false;
+      size_t best = files.size();
+
+      if (it != index.end())
+        for (const Owner &O : it->second)
+          {
+            if (selected[O.object])
+              covered = true;
+            else if (candidate(O.object)
+                     && (best == files.size() || matched[O.object] > matched[best]))
+              best = O.object;
+          }
+
+      if (covered)
+        continue;
+
+      if (best == files.size())
+        this->uncovered.push_back(D.name);
+      else
+        selected[best] = 1;
+    }
+
+  for (size_t k = 0; k < files.size(); ++k)
+    if (selected[k])
+      result.push_back(files[k]);
+
+  return result;
+}
+
+bool ObjectDiscovery::wasCancelled() const
+{
+  return this->cancelled;
+}
+
+size_t ObjectDiscovery::getScanned() const
+{
+  return this->scanned;
+}
+
+size_t ObjectDiscovery::getObjectCount() const
+{
+  return this->objects;
+}
+
+std::vector<std::string> ObjectDiscovery::getUncovered() const
+{
+  return this->uncovered;
+}
+
+// reads the defined global symbols of a mapped file; relocatable files
+// must be ET_REL, executables fall back to .dynsym when stripped
+template <typename Ehdr, typename Shdr, typename Sym>
+bool ObjectDiscovery::readSymbols(const unsigned char *map, size_t size, bool big,
+                                  bool relocatable, std::vector<Definition> &defs)
+{
+  const Ehdr *eh = (const Ehdr *) map;
+  uint64_t type = ElfBytes::field(big, eh->e_type);
+
+  if (relocatable != (type == ET_REL))
+    return false;
+
+  uint64_t shoff = ElfBytes::field(big, eh->e_shoff);
+  uint64_t shnum = ElfBytes::field(big, eh->e_shnum);
+  uint64_t shentsize = ElfBytes::field(big, eh->e_shentsize);
+
+  if (shnum == 0 || shentsize < sizeof(Shdr)
+      || shoff > size || shnum > (size - shoff) / shentsize)
+    return relocatable;
+
+  auto section = [&](uint64_t i) { return (const Shdr *) (map + shoff + i * shentsize); };
+  const Shdr *symtab = NULL;
+
+  for (uint64_t i = 0; i < shnum; ++i)
+    {
+      uint64_t t = ElfBytes::field(big, section(i)->sh_type);
+
+      if (t == SHT_SYMTAB)
+        symtab = section(i);
+      else if (t == SHT_DYNSYM && symtab == NULL && !relocatable)
+        symtab = section(i);
+    }
+
+  if (symtab == NULL)
+    return relocatable;
+
+  uint64_t link = ElfBytes::field(big, symtab->sh_link);
+  if (link >= shnum)
+    return relocatable;
+
+  const Shdr *strtab = section(link);
+  uint64_t stroff = ElfBytes::field(big, strtab->sh_offset);
+  uint64_t strsz = ElfBytes::field(big, strtab->sh_size);
+  uint64_t symoff = ElfBytes::field(big, symtab->sh_offset);
+  uint64_t symsz = ElfBytes::field(big, symtab->sh_size);
+
+  if (!ElfBytes::inside(map, size, map + stroff, strsz)
+      || !ElfBytes::inside(map, size, map + symoff, symsz))
+    return relocatable;
+
+  // the locals come first, sh_info is the first global
+  uint64_t first = ElfBytes::field(big, symtab->sh_info);
+  const Sym *syms = (const Sym *) (map + symoff);
+  const char *strings = (const char *) map + stroff;
+
+  for (uint64_t i = first; i < symsz / sizeof(Sym); ++i)
+    {
+      const Sym &S = syms[i];
+      unsigned int info = ElfBytes::field(big, S.st_info);
+      unsigned int bind = ELF_ST_BIND(info);
+      unsigned int stype = ELF_ST_TYPE(info);
+      uint64_t shndx = ElfBytes::field(big, S.st_shndx);
+      uint64_t name = ElfBytes::field(big, S.st_name);
+
+      if (shndx == SHN_UNDEF || shndx == SHN_ABS || name == 0 || name >= strsz)
+        continue;
+
+      if (bind != STB_GLOBAL && bind != STB_WEAK && bind != STB_GNU_UNIQUE)
+        continue;
+
+      if (stype == STT_SECTION || stype == STT_FILE)
+        continue;
+
+      Definition D;
+
+      D.name.assign(strings + name, strnlen(strings + name, strsz - name));
+      D.size = ElfBytes::field(big, S.st_size);
+      D.bind = bind;
+      defs.push_back(D);
+    }
+
+  return true;
+}
+
+// true when the file is ELF, of the kind asked for, and its symbols
+// could be read
+bool ObjectDiscovery::readFile(const std::string &path, bool relocatable,
+                               std::vector<Definition> &defs)
+{
+  size_t size;
+  const unsigned char *map = map_file(path.c_str(), &size);
+  bool ok = false;
+
+  if (map == NULL)
+    return false;
+
+  if (size >= sizeof(Elf32_External_Ehdr)
+      && map[EI_MAG0] == ELFMAG0 && map[EI_MAG1] == ELFMAG1
+      && map[EI_MAG2] == ELFMAG2 && map[EI_MAG3] == ELFMAG3
+      && (map[EI_DATA] == ELFDATA2LSB || map[EI_DATA] == ELFDATA2MSB))
+    {
+      bool big = map[EI_DATA] == ELFDATA2MSB;
+
+      if (map[EI_CLASS] == ELFCLASS64 && size >= sizeof(Elf64_External_Ehdr))
+        ok = readSymbols<Elf64_External_Ehdr, Elf64_External_Shdr, Elf64_External_Sym>(
+               map, size, big, relocatable, defs);
+      else if (map[EI_CLASS] == ELFCLASS32)
+        ok = readSymbols<Elf32_External_Ehdr, Elf32_External_Shdr, Elf32_External_Sym>(
+               map, size, big, relocatable, defs);
+    }
+
+  unmap_file(map, size);
+
+  return ok;
+}
+
+// collects the regular files under a directory, symbolic links aren't
+// followed so the walk can't loop
+void ObjectDiscovery::walk(const std::string &dir, std::vector<std::string> &files,
+                           const std::atomic<bool> *cancel)
+{
+  if (cancel != nullptr && cancel->load())
+    return;
+
+  DIR *D = opendir(dir.c_str());
+  struct dirent *entry;
+
+  if (D == NULL)
+    return;
+
+  while ((entry = readdir(D)) != NULL)
+    {
+      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        continue;
+
+      std::string path = dir + "/" + entry->d_name;
+      unsigned char type = entry->d_type;
+
+      if (type == DT_UNKNOWN)
+        {
+          struct stat st;
+
+          if (lstat(path.c_str(), &st) != 0)
+            continue;
+
+          type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+
+      if (type == DT_DIR)
+        walk(path, files, cancel);
+      else if (type == DT_REG)
+        files.push_back(path);
+    }
+
+  closedir(D);
+}
+
+ObjectDiscovery::ObjectDiscovery()
+  : scanned(0), objects(0), cancelled(false)
+{}
+
+ObjectDiscovery::~ObjectDiscovery()
+{}
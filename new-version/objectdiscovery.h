@@ -0,0 +1,70 @@
+#ifndef OBJECTDISCOVERY_H
+#define OBJECTDISCOVERY_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+class AnalysisListener;
+
+// Finds the object files an executable was linked from in a build tree.
+// Every file under the root is sniffed on several threads and the
+// relocatable ELF files have their defined global symbols read without
+// bfd, giving an index from symbol name to the objects defining it. An
+// object is picked when the executable defines its symbols with the same
+// sizes; a name defined by several objects goes to the one that matches
+// the executable best, so stale copies of a file are left out.
+class ObjectDiscovery
+{
+public:
+  // the paths of the objects, in the order they were found; the listener
+  // hears of the scan from the calling thread, and *cancel* stops it at
+  // the next directory or file with nothing found
+  std::vector<std::string> discover(const std::string &, const std::string &,
+                                    AnalysisListener * = nullptr,
+                                    const std::atomic<bool> * = nullptr);
+
+  bool wasCancelled() const;
+
+  size_t getScanned() const;
+  size_t getObjectCount() const;
+
+  // global symbols of the executable no object in the tree defines
+  std::vector<std::string> getUncovered() const;
+
+  ObjectDiscovery();
+  virtual ~ObjectDiscovery();
+
+protected:
+private:
+  // a defined global symbol of a file
+  struct Definition
+  {
+    std::string name;
+    uint64_t size;
+    unsigned int bind;          // STB_GLOBAL, STB_WEAK or STB_GNU_UNIQUE
+  };
+
+  // where an indexed symbol is defined
+  struct Owner
+  {
+    size_t object;
+    uint64_t size;
+  };
+
+  template <typename Ehdr, typename Shdr, typename Sym>
+  static bool readSymbols(const unsigned char *, size_t, bool, bool,
+                          std::vector<Definition> &);
+  static bool readFile(const std::string &, bool, std::vector<Definition> &);
+  static void walk(const std::string &, std::vector<std::string> &,
+                   const std::atomic<bool> *);
+
+  size_t scanned;
+  size_t objects;
+  bool cancelled;
+  std::vector<std::string> uncovered;
+};
+
+#endif // OBJECTDISCOVERY_H
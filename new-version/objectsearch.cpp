@@ -0,0 +1,41 @@
+#include "objectsearch.h"
+
+ObjectSearch::Relay::Relay(ObjectSearch *search)
+  : owner(search)
+{}
+
+void ObjectSearch::Relay::progress(std::string phase, std::string file, int done, int total)
+{
+  emit this->owner->progress(QString::fromStdString(phase), QString::fromStdString(file), done, total);
+}
+
+ObjectSearch::ObjectSearch(std::string exe, std::string root)
+  : exe(exe), root(root), cancelled(false)
+{}
+
+ObjectSearch::~ObjectSearch()
+{}
+
+void ObjectSearch::cancel()
+{
+  this->cancelled = true;
+}
+
+std::vector<std::string> ObjectSearch::getFound() const
+{
+  return this->found;
+}
+
+size_t ObjectSearch::getObjectCount() const
+{
+  return this->discovery.getObjectCount();
+}
+
+void ObjectSearch::run()
+{
+  Relay relay(this);
+
+  this->found = this->discovery.discover(this->exe, this->root, &relay, &this->cancelled);
+
+  emit finished(this->discovery.wasCancelled() ? ANALYSIS_CANCELLED : ANALYSIS_DONE);
+}
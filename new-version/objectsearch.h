@@ -0,0 +1,61 @@
+#ifndef OBJECTSEARCH_H
+#define OBJECTSEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "objectdiscovery.h"
+#include "analysisrun.h"
+
+// Looks for the objects of an executable in a build tree away from the
+// GUI thread, through ObjectDiscovery. The walk and the sniffing only
+// read files by path, so nothing the window holds is touched meanwhile.
+class ObjectSearch : public QObject
+{
+  Q_OBJECT
+
+public:
+  ObjectSearch(std::string, std::string);
+  ~ObjectSearch();
+
+  // asks the search to stop, it does so at the next directory or file
+  void cancel();
+
+  // valid once finished() is received
+  std::vector<std::string> getFound() const;
+  size_t getObjectCount() const;
+
+public slots:
+  void run();
+
+signals:
+  void progress(QString phase, QString file, int done, int total);
+  // ANALYSIS_DONE or ANALYSIS_CANCELLED
+  void finished(int outcome);
+
+private:
+  // turns what the search reports into signals
+  class Relay : public AnalysisListener
+  {
+  public:
+    explicit Relay(ObjectSearch *);
+
+    void progress(std::string, std::string, int, int);
+
+  private:
+    ObjectSearch *owner;
+  };
+
+  std::string exe;
+  std::string root;
+
+  ObjectDiscovery discovery;
+  std::vector<std::string> found;
+
+  std::atomic<bool> cancelled;
+};
+
+#endif // OBJECTSEARCH_H
@@ -11,8 +11,17 @@ objecttab::objecttab(QWidget *parent) :
 
   ui->objFunctions->activateWindow();
 
+  this->functions = new FunctionTreeModel(this);
+  this->symbols = new SymbolListModel(this);
+
+  ui->objFunctionsTree->setModel(this->functions);
+  ui->objDataList->setModel(this->symbols);
+
+  // every row has the same height, the view doesn't need to ask
+  ui->objFunctionsTree->setUniformRowHeights(true);
+  ui->objDataList->setUniformItemSizes(true);
+
   ui->objFunctionsTree->header()->hide();
-  ui->objFunctionsTree->headerItem()->setText(0, "Offset");
 }
 
 objecttab::~objecttab()
@@ -20,51 +29,75 @@ objecttab::~objecttab()
   delete ui;
 }
 
-void objecttab::addSymbol(std::string sym)
+void objecttab::setSymbols(std::vector<SymbolListModel::Entry> entries)
+{
+  this->symbols->setEntries(entries);
+}
+
+void objecttab::clear()
+{
+  this->functions->clear();
+  this->symbols->clear();
+}
+
+void objecttab::setFunctions(std::vector<FunctionTreeModel::Entry> entries)
+{
+  this->functions->setEntries(entries);
+
+  ui->objFunctionsTree->setColumnWidth(0, 150);
+  this->toggleHex(this->hex);
+  ui->objFunctionsTree->header()->show();
+}
+
+// appends functions as they are disassembled
+void objecttab::addFunctions(std::vector<FunctionTreeModel::Entry> entries)
 {
-  ui->objDataList->addItem(QString::fromStdString(sym));
+  bool first = (this->functions->rowCount() == 0);
+
+  this->functions->insertEntries(this->functions->rowCount(), entries);
+
+  if (first)
+    {
+      ui->objFunctionsTree->setColumnWidth(0, 150);
+      this->toggleHex(this->hex);
+      ui->objFunctionsTree->header()->show();
+    }
 }
 
 void objecttab::selectSymbol(QString sym) const
 {
-  int rows = ui->objDataList->count();
+  int row = this->symbols->findRow(sym.toStdString());
 
-  for (int row = 0; row < rows; ++row)
+  if (row >= 0)
     {
-      QString rowName = ui->objDataList->item(row)->text();
-      if (rowName.compare(sym) == 0)
-        {
-          ui->objDataList->item(row)->setSelected(true);
-          break;
-        }
+      QModelIndex index = this->symbols->index(row);
+
+      ui->objDataList->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect);
+      ui->objDataList->scrollTo(index);
     }
   ui->objToolBox->setCurrentIndex(0);
 }
 
 void objecttab::selectFunction(QString sym, int line) const
 {
-  int rows = ui->objFunctionsTree->topLevelItemCount();
+  int row = this->functions->findRow(sym.toStdString());
 
-  QList<QTreeWidgetItem *> selectedItems = ui->objFunctionsTree->selectedItems();
-  for (QTreeWidgetItem *item : selectedItems)
-    {
-      item->setSelected(false);
-      item->setExpanded(false);
-    }
+  ui->objFunctionsTree->collapseAll();
+  ui->objFunctionsTree->selectionModel()->clearSelection();
 
-  for (int row = 0; row < rows; ++row)
+  if (row >= 0)
     {
-      QString rowName = ui->objFunctionsTree->topLevelItem(row)->text(0);
-      if (rowName.compare(sym) == 0)
-        {
-          ui->objFunctionsTree->topLevelItem(row)->setSelected(true);
-          ui->objFunctionsTree->topLevelItem(row)->setExpanded(true);
+      QModelIndex function = this->functions->index(row, 0);
+      QModelIndex target = function;
 
-          if (line >= 0 && line < ui->objFunctionsTree->topLevelItem(row)->childCount())
-            ui->objFunctionsTree->topLevelItem(row)->child(line)->setSelected(true);
+      ui->objFunctionsTree->expand(function);
 
-          break;
-        }
+      if (line >= 0 && line < this->functions->rowCount(function))
+        target = this->functions->index(line, 0, function);
+
+      ui->objFunctionsTree->selectionModel()->select(target, QItemSelectionModel::ClearAndSelect
+                                                     | QItemSelectionModel::Rows);
+      ui->objFunctionsTree->scrollTo(target);
     }
   ui->objToolBox->setCurrentIndex(1);
 }
@@ -74,13 +107,16 @@ void objecttab::selectFunctionLine(QString sym, int line) const
   this->selectFunction(sym, line);
 }
 
-void objecttab::toggleHex(bool checked) const
+Function *objecttab::getFunction(const std::string &name) const
 {
-  ui->objFunctionsTree->setColumnHidden(1, checked);
-  ui->objFunctionsTree->setColumnHidden(2, !checked);
+  int row = this->functions->findRow(name);
+
+  return (row < 0) ? nullptr : this->functions->entry(row).function;
 }
 
-QTreeWidget *objecttab::getTree() const
+void objecttab::toggleHex(bool checked)
 {
-  return ui->objFunctionsTree;
+  this->hex = checked;
+  ui->objFunctionsTree->setColumnHidden(1, checked);
+  ui->objFunctionsTree->setColumnHidden(2, !checked);
 }
@@ -2,7 +2,9 @@
 #define OBJECTTAB_H
 
 #include <QWidget>
-#include <QTreeWidget>
+
+#include "functiontreemodel.h"
+#include "symbollistmodel.h"
 
 namespace Ui {
   class objecttab;
@@ -16,15 +18,24 @@ public:
   explicit objecttab(QWidget *parent = 0);
   ~objecttab();
 
-  void addSymbol(std::string);
+  void clear();
+  void setSymbols(std::vector<SymbolListModel::Entry>);
+  void setFunctions(std::vector<FunctionTreeModel::Entry>);
+  void addFunctions(std::vector<FunctionTreeModel::Entry>);
   void selectSymbol(QString) const;
   void selectFunction(QString, int = -1) const;
   void selectFunctionLine(QString, int) const;
-  void toggleHex(bool) const;
-  QTreeWidget *getTree() const;
+  // the disassembled function of a name, or nullptr
+  Function *getFunction(const std::string &) const;
+  void toggleHex(bool);
 
 private:
   Ui::objecttab *ui;
+
+  FunctionTreeModel *functions;
+  SymbolListModel *symbols;
+  // whether the opcodes are shown instead of the instructions
+  bool hex = false;
 };
 
 #endif // OBJECTTAB_H
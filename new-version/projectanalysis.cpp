@@ -0,0 +1,59 @@
+#include "projectanalysis.h"
+
+ProjectAnalysis::Relay::Relay(ProjectAnalysis *analysis)
+  : owner(analysis)
+{}
+
+void ProjectAnalysis::Relay::progress(std::string phase, std::string file, int done, int total)
+{
+  emit this->owner->progress(QString::fromStdString(phase), QString::fromStdString(file), done, total);
+}
+
+void ProjectAnalysis::Relay::bindingReady()
+{
+  emit this->owner->bindingReady();
+}
+
+ProjectAnalysis::ProjectAnalysis(ELFFile *exe, std::vector<ELFFile *> objs, std::string root)
+  : core(exe, objs, root), cancelled(false)
+{}
+
+ProjectAnalysis::~ProjectAnalysis()
+{}
+
+void ProjectAnalysis::cancel()
+{
+  this->cancelled = true;
+}
+
+std::vector<std::pair<ELFFile *, int> > ProjectAnalysis::getErrors() const
+{
+  return this->core.getErrors();
+}
+
+AddressBinding *ProjectAnalysis::getBinding() const
+{
+  return this->core.getBinding();
+}
+
+std::vector<std::vector<std::string> > ProjectAnalysis::getSymbolLists() const
+{
+  return this->core.getSymbolLists();
+}
+
+FunctionDiff *ProjectAnalysis::getDiff() const
+{
+  return this->core.getDiff();
+}
+
+FunctionChannel *ProjectAnalysis::getChannel()
+{
+  return &this->channel;
+}
+
+void ProjectAnalysis::run()
+{
+  Relay relay(this);
+
+  emit finished(this->core.run(&relay, &this->cancelled, &this->channel));
+}
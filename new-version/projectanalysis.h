@@ -0,0 +1,70 @@
+#ifndef PROJECTANALYSIS_H
+#define PROJECTANALYSIS_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "analysisrun.h"
+
+// Runs a project away from the GUI thread, through AnalysisRun. bfd isn't
+// thread safe, so while run() goes only this object's thread may touch
+// the files; everything the GUI needs is handed over through the signals
+// and the function channel, and each result is left alone by the analysis
+// once it has been handed over.
+class ProjectAnalysis : public QObject
+{
+  Q_OBJECT
+
+public:
+  ProjectAnalysis(ELFFile *, std::vector<ELFFile *>, std::string);
+  ~ProjectAnalysis();
+
+  // asks the analysis to stop, it does so at the next file or section
+  void cancel();
+
+  // files that couldn't be loaded and why, once finished(ANALYSIS_FAILED)
+  std::vector<std::pair<ELFFile *, int> > getErrors() const;
+
+  // valid once bindingReady() is received; the caller owns the binding
+  AddressBinding *getBinding() const;
+  // the symbols of every object, in the order of the objects
+  std::vector<std::vector<std::string> > getSymbolLists() const;
+
+  // valid once finished(ANALYSIS_DONE) is received; the caller owns it
+  FunctionDiff *getDiff() const;
+
+  // every function, as soon as it's disassembled, with its file
+  FunctionChannel *getChannel();
+
+public slots:
+  void run();
+
+signals:
+  void progress(QString phase, QString file, int done, int total);
+  void bindingReady();
+  void finished(int outcome);
+
+private:
+  // turns what the run reports into signals
+  class Relay : public AnalysisListener
+  {
+  public:
+    explicit Relay(ProjectAnalysis *);
+
+    void progress(std::string, std::string, int, int);
+    void bindingReady();
+
+  private:
+    ProjectAnalysis *owner;
+  };
+
+  AnalysisRun core;
+
+  std::atomic<bool> cancelled;
+  FunctionChannel channel;
+};
+
+#endif // PROJECTANALYSIS_H
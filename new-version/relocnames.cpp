@@ -0,0 +1,109 @@
+#include <vector>
+
+#include "relocnames.h"
+
+struct RelocName
+{
+  unsigned int type;
+  const char *name;
+};
+
+// reloc-macros.h is kept out and its macros are given here instead, so
+// every elf/*.h relocation list expands to a {number, "name"} table
+#define _RELOC_MACROS_H
+#define START_RELOC_NUMBERS(name)   static constexpr RelocName name[] = {
+#define RELOC_NUMBER(name, number)  { number, #name },
+#define FAKE_RELOC(name, number)
+#define EMPTY_RELOC(name)
+#define END_RELOC_NUMBERS(name)     };
+
+#include "elf/x86-64.h"
+#include "elf/i386.h"
+#include "elf/aarch64.h"
+#include "elf/arm.h"
+#include "elf/riscv.h"
+
+#undef START_RELOC_NUMBERS
+#undef RELOC_NUMBER
+#undef FAKE_RELOC
+#undef EMPTY_RELOC
+#undef END_RELOC_NUMBERS
+
+namespace RelocNames
+{
+  // one slot per relocation number, the first name given wins
+  class DenseTable
+  {
+  public:
+    DenseTable() {}
+
+    template <size_t N>
+    explicit DenseTable(const RelocName (&table)[N])
+    {
+      unsigned int max = 0;
+
+      for (size_t i = 0; i < N; ++i)
+        if (table[i].type > max)
+          max = table[i].type;
+
+      this->names.assign(max + 1, nullptr);
+
+      for (size_t i = 0; i < N; ++i)
+        if (this->names[table[i].type] == nullptr)
+          this->names[table[i].type] = table[i].name;
+    }
+
+    const char *operator()(unsigned int type) const
+    {
+      return (type < this->names.size()) ? this->names[type] : nullptr;
+    }
+
+  private:
+    std::vector<const char *> names;
+  };
+
+  // built once, on first use, before any lookup can see them
+  static const DenseTable &table_for(bfd *abfd)
+  {
+    static const DenseTable x86_64(elf_x86_64_reloc_type);
+    static const DenseTable i386(elf_i386_reloc_type);
+    static const DenseTable aarch64(elf_aarch64_reloc_type);
+    static const DenseTable arm(elf_arm_reloc_type);
+    static const DenseTable riscv(elf_riscv_reloc_type);
+    static const DenseTable none;
+
+    switch (bfd_get_arch(abfd))
+      {
+      case bfd_arch_i386:
+        if (bfd_get_mach(abfd) & (bfd_mach_x86_64 | bfd_mach_x64_32))
+          return x86_64;
+        return i386;
+      case bfd_arch_aarch64:
+        return aarch64;
+      case bfd_arch_arm:
+        return arm;
+      case bfd_arch_riscv:
+        return riscv;
+      default:
+        return none;
+      }
+  }
+
+  const char *name(bfd *abfd, unsigned int type)
+  {
+    if (bfd_get_flavour(abfd) != bfd_target_elf_flavour)
+      return nullptr;
+
+    return table_for(abfd)(type);
+  }
+
+  const char *name(bfd *abfd, const arelent *rel)
+  {
+    if (rel->howto == NULL)
+      return nullptr;
+
+    const char *n = name(abfd, rel->howto->type);
+
+    return (n != nullptr) ? n : rel->howto->name;
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef RELOCNAMES_H
+#define RELOCNAMES_H
+
+// this needs to be defined before any bfd.h include
+// due to a 'won't fix' bug
+#define PACKAGE "elfdetective"
+
+#include <bfd.h>
+
+// Relocation type names for x86-64, i386, AArch64, ARM and RISC-V. The
+// tables are built by the compiler from the RELOC_NUMBER lists in
+// elf/*.h, so naming a relocation is a single indexed load.
+namespace RelocNames
+{
+  // name of a relocation type of the file's architecture, or NULL
+  const char *name(bfd *, unsigned int);
+
+  // name of a relocation, bfd's howto name for other architectures
+  const char *name(bfd *, const arelent *);
+}
+
+#endif // RELOCNAMES_H
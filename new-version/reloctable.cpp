@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "reloctable.h"
+#include "tools.h"
+
+RelocTable::Cursor::Cursor() : at(nullptr), end(nullptr) {}
+
+RelocTable::Cursor::Cursor(arelent **from, arelent **to) : at(from), end(to) {}
+
+arelent *RelocTable::Cursor::current() const
+{
+  return (this->at < this->end) ? *this->at : nullptr;
+}
+
+void RelocTable::Cursor::next()
+{
+  if (this->at < this->end)
+    ++this->at;
+}
+
+bool RelocTable::Cursor::atEnd() const
+{
+  return this->at >= this->end;
+}
+
+void RelocTable::load(bfd *abfd, asymbol **syms)
+{
+  this->clear();
+  this->sections.resize(abfd->section_count);
+
+  // bfd reads the file, so canonicalizing stays on this thread
+  for (asection *section = abfd->sections; section != NULL; section = section->next)
+    {
+      // .debug_* carry most relocations of a -g object, and only the
+      // sections loaded at run time are disassembled or verified
+      if ((section->flags & SEC_RELOC) == 0 || (section->flags & SEC_ALLOC) == 0
+          || section->index >= this->sections.size())
+        continue;
+
+      long relsize = bfd_get_reloc_upper_bound(abfd, section);
+      if (relsize <= 0)
+        continue;
+
+      SectionRelocs &S = this->sections[section->index];
+
+      S.relbuf = (arelent **) malloc(relsize);
+      S.relcount = bfd_canonicalize_reloc(abfd, section, S.relbuf, syms);
+
+      if (S.relcount <= 0)
+        {
+          free(S.relbuf);
+          S.relbuf = nullptr;
+          S.relcount = 0;
+        }
+    }
+
+  // sorting only touches our own arrays, the sections are
+  // spread over the available cores
+  std::atomic<size_t> next(0);
+  size_t threads = worker_count(this->sections.size());
+
+  auto worker = [&]()
+    {
+      for (size_t k = next++; k < this->sections.size(); k = next++)
+        sort_relocs(this->sections[k].relbuf, this->sections[k].relcount);
+    };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t = 1; t < threads; ++t)
+    workers.push_back(std::thread(worker));
+
+  if (threads)
+    worker();
+
+  for (std::thread &t : workers)
+    t.join();
+}
+
+long RelocTable::count(asection *section) const
+{
+  if (section->index >= this->sections.size())
+    return 0;
+
+  return this->sections[section->index].relcount;
+}
+
+arelent **RelocTable::begin(asection *section) const
+{
+  if (section->index >= this->sections.size())
+    return nullptr;
+
+  return this->sections[section->index].relbuf;
+}
+
+arelent **RelocTable::end(asection *section) const
+{
+  if (section->index >= this->sections.size())
+    return nullptr;
+
+  return this->sections[section->index].relbuf + this->sections[section->index].relcount;
+}
+
+arelent **RelocTable::lowerBound(asection *section, bfd_vma address) const
+{
+  return std::lower_bound(this->begin(section), this->end(section), address,
+                          [](const arelent *r, bfd_vma a) {return r->address < a;});
+}
+
+RelocTable::Cursor RelocTable::cursor(asection *section, bfd_vma address) const
+{
+  return Cursor(this->lowerBound(section, address), this->end(section));
+}
+
+void RelocTable::loadDynamic(bfd *abfd, asymbol **dynsyms)
+{
+  free(this->dynamic.relbuf);
+  this->dynamic.relbuf = nullptr;
+  this->dynamic.relcount = 0;
+
+  long relsize = bfd_get_dynamic_reloc_upper_bound(abfd);
+  if (relsize <= 0)
+    return;
+
+  this->dynamic.relbuf = (arelent **) malloc(relsize);
+  this->dynamic.relcount = bfd_canonicalize_dynamic_reloc(abfd, this->dynamic.relbuf, dynsyms);
+
+  if (this->dynamic.relcount <= 0)
+    {
+      free(this->dynamic.relbuf);
+      this->dynamic.relbuf = nullptr;
+      this->dynamic.relcount = 0;
+      return;
+    }
+
+  sort_relocs(this->dynamic.relbuf, this->dynamic.relcount);
+}
+
+long RelocTable::dynamicCount() const
+{
+  return this->dynamic.relcount;
+}
+
+arelent *RelocTable::findDynamic(bfd_vma vma) const
+{
+  arelent **first = this->dynamic.relbuf;
+  arelent **last = first + this->dynamic.relcount;
+  arelent **it = std::lower_bound(first, last, vma,
+                                  [](const arelent *r, bfd_vma a) {return r->address < a;});
+
+  return (it != last && (*it)->address == vma) ? *it : nullptr;
+}
+
+void RelocTable::clear()
+{
+  for (SectionRelocs &S : this->sections)
+    free(S.relbuf);
+
+  this->sections.clear();
+}
+
+RelocTable::RelocTable()
+{
+  this->dynamic.relbuf = nullptr;
+  this->dynamic.relcount = 0;
+}
+
+RelocTable::~RelocTable()
+{
+  this->clear();
+  free(this->dynamic.relbuf);
+}
@@ -0,0 +1,71 @@
+#ifndef RELOCTABLE_H
+#define RELOCTABLE_H
+
+#include <vector>
+
+// this needs to be defined before any bfd.h include
+// due to a 'won't fix' bug
+#define PACKAGE "elfdetective"
+
+#include <bfd.h>
+
+// The relocations of every loaded section of a file, canonicalized once
+// and sorted by address; debug sections are left out, nothing reads
+// them. After load() the table is only read, so the disassembly, the diff
+// and the link verifier can share it between threads.
+class RelocTable
+{
+public:
+  // walks the relocations of one section in address order, the
+  // disassembly annotates every line from one
+  class Cursor
+  {
+  public:
+    Cursor();
+    Cursor(arelent **, arelent **);
+
+    arelent *current() const;
+    void next();
+    bool atEnd() const;
+
+  private:
+    arelent **at;
+    arelent **end;
+  };
+
+  void load(bfd *, asymbol **);
+
+  long count(asection *) const;
+  arelent **begin(asection *) const;
+  arelent **end(asection *) const;
+
+  // first relocation of the section at or after *address*
+  arelent **lowerBound(asection *, bfd_vma) const;
+
+  Cursor cursor(asection *, bfd_vma = 0) const;
+
+  // dynamic relocations of a linked file, their addresses are vmas
+  void loadDynamic(bfd *, asymbol **);
+  long dynamicCount() const;
+
+  // the dynamic relocation at exactly *vma*, or NULL
+  arelent *findDynamic(bfd_vma) const;
+
+  RelocTable();
+  virtual ~RelocTable();
+
+protected:
+private:
+  struct SectionRelocs
+  {
+    arelent **relbuf;
+    long relcount;
+  };
+
+  void clear();
+
+  std::vector<SectionRelocs> sections;
+  SectionRelocs dynamic;
+};
+
+#endif // RELOCTABLE_H
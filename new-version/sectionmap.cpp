@@ -0,0 +1,229 @@
+#include <cstring>
+
+#include "sectionmap.h"
+#include "elfbytes.h"
+#include "tools.h"
+#include "elf/common.h"
+#include "elf/external.h"
+#include "elf/internal.h"
+
+SectionMap::SectionMap()
+  : map(NULL), size(0), big(false), is64(false), relocatable(false),
+    symtab(0), symbolsRead(false)
+{}
+
+SectionMap::~SectionMap()
+{
+  this->close();
+}
+
+bool SectionMap::open(const std::string &path)
+{
+  this->close();
+
+  this->map = map_file(path.c_str(), &this->size);
+  if (this->map == NULL)
+    return false;
+
+  bool ok = false;
+
+  if (this->size >= sizeof(Elf32_External_Ehdr)
+      && this->map[EI_MAG0] == ELFMAG0 && this->map[EI_MAG1] == ELFMAG1
+      && this->map[EI_MAG2] == ELFMAG2 && this->map[EI_MAG3] == ELFMAG3
+      && (this->map[EI_DATA] == ELFDATA2LSB || this->map[EI_DATA] == ELFDATA2MSB))
+    {
+      this->big = this->map[EI_DATA] == ELFDATA2MSB;
+
+      if (this->map[EI_CLASS] == ELFCLASS64 && this->size >= sizeof(Elf64_External_Ehdr))
+        {
+          this->is64 = true;
+          ok = this->readSections<Elf64_External_Ehdr, Elf64_External_Shdr>();
+        }
+      else if (this->map[EI_CLASS] == ELFCLASS32)
+        {
+          this->is64 = false;
+          ok = this->readSections<Elf32_External_Ehdr, Elf32_External_Shdr>();
+        }
+    }
+
+  if (!ok)
+    this->close();
+
+  return ok;
+}
+
+void SectionMap::close()
+{
+  unmap_file(this->map, this->size);
+
+  this->map = NULL;
+  this->size = 0;
+  this->sections.clear();
+  this->symtab = 0;
+  this->symbolsRead = false;
+  this->symbols.clear();
+}
+
+const std::vector<MappedSection> &SectionMap::getSections() const
+{
+  return this->sections;
+}
+
+const unsigned char *SectionMap::bytes(size_t i) const
+{
+  if (i >= this->sections.size() || this->sections[i].nobits)
+    return NULL;
+
+  return this->map + this->sections[i].offset;
+}
+
+bool SectionMap::findSymbol(const std::string &name, size_t *section, uint64_t *offset)
+{
+  if (!this->symbolsRead)
+    {
+      if (this->is64)
+        this->readSymbols<Elf64_External_Sym>();
+      else
+        this->readSymbols<Elf32_External_Sym>();
+
+      this->symbolsRead = true;
+    }
+
+  auto it = this->symbols.find(name);
+  if (it == this->symbols.end())
+    return false;
+
+  *section = it->second.section;
+  *offset = it->second.offset;
+
+  return true;
+}
+
+// the allocated sections of a relocatable file all start at 0, so an
+// address can't tell them apart
+bool SectionMap::findAddress(uint64_t vma, size_t *section, uint64_t *offset) const
+{
+  if (this->relocatable)
+    return false;
+
+  for (size_t i = 0; i < this->sections.size(); ++i)
+    {
+      const MappedSection &S = this->sections[i];
+
+      if (S.size != 0 && S.vma != 0 && vma >= S.vma && vma - S.vma < S.size)
+        {
+          *section = i;
+          *offset = vma - S.vma;
+          return true;
+        }
+    }
+
+  return false;
+}
+
+template <typename Ehdr, typename Shdr>
+bool SectionMap::readSections()
+{
+  const Ehdr *eh = (const Ehdr *) this->map;
+  bool big = this->big;
+
+  uint64_t shoff = ElfBytes::field(big, eh->e_shoff);
+  uint64_t shnum = ElfBytes::field(big, eh->e_shnum);
+  uint64_t shentsize = ElfBytes::field(big, eh->e_shentsize);
+  uint64_t shstrndx = ElfBytes::field(big, eh->e_shstrndx);
+
+  this->relocatable = ElfBytes::field(big, eh->e_type) == ET_REL;
+
+  if (shnum == 0 || shentsize < sizeof(Shdr)
+      || shoff > this->size || shnum > (this->size - shoff) / shentsize)
+    return false;
+
+  auto header = [&](uint64_t i) { return (const Shdr *) (this->map + shoff + i * shentsize); };
+
+  const unsigned char *names = NULL;
+  uint64_t namesz = 0;
+
+  if (shstrndx < shnum)
+    {
+      uint64_t off = ElfBytes::field(big, header(shstrndx)->sh_offset);
+      namesz = ElfBytes::field(big, header(shstrndx)->sh_size);
+
+      if (ElfBytes::inside(this->map, this->size, this->map + off, namesz))
+        names = this->map + off;
+    }
+
+  for (uint64_t i = 0; i < shnum; ++i)
+    {
+      const Shdr *H = header(i);
+      MappedSection S;
+      uint64_t name = ElfBytes::field(big, H->sh_name);
+      uint64_t type = ElfBytes::field(big, H->sh_type);
+
+      if (names != NULL && name < namesz)
+        S.name = std::string((const char *) names + name,
+                             strnlen((const char *) names + name, namesz - name));
+
+      S.offset = ElfBytes::field(big, H->sh_offset);
+      S.size = ElfBytes::field(big, H->sh_size);
+      S.vma = ElfBytes::field(big, H->sh_addr);
+      S.link = ElfBytes::field(big, H->sh_link);
+      S.nobits = (type == SHT_NOBITS || type == SHT_NULL);
+
+      // a section running past the end of the file is cut short
+      if (!S.nobits && !ElfBytes::inside(this->map, this->size, this->map + S.offset, S.size))
+        S.size = (S.offset < this->size) ? this->size - S.offset : 0;
+
+      if (type == SHT_SYMTAB || (type == SHT_DYNSYM && this->symtab == 0))
+        this->symtab = i;
+
+      this->sections.push_back(S);
+    }
+
+  return true;
+}
+
+// every named symbol defined in a section, the first one of a name wins
+template <typename Sym>
+void SectionMap::readSymbols()
+{
+  if (this->symtab == 0)
+    return;
+
+  const MappedSection &table = this->sections[this->symtab];
+  uint64_t link = table.link;
+
+  if (link >= this->sections.size() || this->sections[link].nobits)
+    return;
+
+  const unsigned char *strings = this->bytes(link);
+  uint64_t strsz = this->sections[link].size;
+
+  const Sym *syms = (const Sym *) this->bytes(this->symtab);
+  if (syms == NULL)
+    return;
+
+  for (uint64_t i = 1; i < table.size / sizeof(Sym); ++i)
+    {
+      const Sym &S = syms[i];
+      unsigned int stype = ELF_ST_TYPE(ElfBytes::field(this->big, S.st_info));
+      uint64_t shndx = ElfBytes::field(this->big, S.st_shndx);
+      uint64_t name = ElfBytes::field(this->big, S.st_name);
+      uint64_t value = ElfBytes::field(this->big, S.st_value);
+
+      if (name == 0 || name >= strsz || shndx == SHN_UNDEF || shndx >= this->sections.size())
+        continue;
+
+      if (stype == STT_SECTION || stype == STT_FILE)
+        continue;
+
+      // symbols of a relocatable file hold section offsets
+      const MappedSection &in = this->sections[shndx];
+      uint64_t offset = this->relocatable ? value : value - in.vma;
+
+      if (!this->relocatable && value < in.vma)
+        continue;
+
+      const char *s = (const char *) strings + name;
+      this->symbols.emplace(std::string(s, strnlen(s, strsz - name)), Place{shndx, offset});
+    }
+}
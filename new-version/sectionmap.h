@@ -0,0 +1,74 @@
+#ifndef SECTIONMAP_H
+#define SECTIONMAP_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// a section header of a mapped file
+struct MappedSection
+{
+  std::string name;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t vma;
+
+  // the header it refers to, the string table of a symbol table
+  uint64_t link;
+
+  // .bss and the like take no room in the file
+  bool nobits;
+};
+
+// An ELF file mapped read only, with its section headers read straight
+// from the mapping and without bfd. Nothing is copied out of the file, so
+// only the pages that are looked at are ever read, however large it is.
+// The symbol table is indexed the first time a symbol is looked for.
+class SectionMap
+{
+public:
+  bool open(const std::string &);
+  void close();
+
+  // every section header, in the order of the file, indexed like st_shndx
+  const std::vector<MappedSection> &getSections() const;
+
+  // the bytes of a section, NULL when the file holds none
+  const unsigned char *bytes(size_t) const;
+
+  // where a symbol or an address is, as a section and an offset in it
+  bool findSymbol(const std::string &, size_t *, uint64_t *);
+  bool findAddress(uint64_t, size_t *, uint64_t *) const;
+
+  SectionMap();
+  virtual ~SectionMap();
+
+protected:
+private:
+  struct Place
+  {
+    size_t section;
+    uint64_t offset;
+  };
+
+  template <typename Ehdr, typename Shdr>
+  bool readSections();
+  template <typename Sym>
+  void readSymbols();
+
+  const unsigned char *map;
+  size_t size;
+  bool big;
+  bool is64;
+  bool relocatable;
+
+  std::vector<MappedSection> sections;
+
+  size_t symtab;
+  bool symbolsRead;
+  std::unordered_map<std::string, Place> symbols;
+};
+
+#endif // SECTIONMAP_H
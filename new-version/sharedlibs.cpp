@@ -0,0 +1,714 @@
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <glob.h>
+
+#include "sharedlibs.h"
+#include "elfbytes.h"
+#include "tools.h"
+#include "elf/common.h"
+#include "elf/external.h"
+#include "elf/internal.h"
+
+static std::string dir_name(const std::string &path)
+{
+  size_t slash = path.rfind('/');
+
+  if (slash == std::string::npos)
+    return ".";
+  if (slash == 0)
+    return "/";
+
+  return path.substr(0, slash);
+}
+
+// the hash functions of the two tables, from the gABI and from glibc
+static uint32_t sysv_hash(const char *name)
+{
+  uint32_t h = 0, g;
+
+  for (const unsigned char *c = (const unsigned char *) name; *c; ++c)
+    {
+      h = (h << 4) + *c;
+      g = h & 0xf0000000;
+      if (g)
+        h ^= g >> 24;
+      h &= ~g;
+    }
+
+  return h;
+}
+
+static uint32_t gnu_hash(const char *name)
+{
+  uint32_t h = 5381;
+
+  for (const unsigned char *c = (const unsigned char *) name; *c; ++c)
+    h = h * 33 + *c;
+
+  return h;
+}
+
+void SharedLibs::load(const std::string &exe, const std::string &root)
+{
+  for (Image &I : this->images)
+    unmap_file(I.map, I.size);
+
+  this->images.clear();
+  this->missing.clear();
+  this->confDirs.clear();
+  this->seen.clear();
+
+  this->sysroot = root;
+  while (!this->sysroot.empty() && this->sysroot.back() == '/')
+    this->sysroot.pop_back();
+
+  this->readLdConf(this->sysroot + "/etc/ld.so.conf", 0);
+
+  Image E;
+
+  if (!this->open(E, exe))
+    return;
+
+  E.name = exe.substr(exe.rfind('/') + 1);
+  this->images.push_back(E);
+
+  std::vector<Pending> level;
+  for (const std::string &N : this->images[0].needed)
+    level.push_back(Pending{N, 0});
+
+  std::unordered_set<std::string> paths;
+
+  // breadth first like the dynamic loader, which is also the order the
+  // libraries are searched for symbols; a level is loaded at once
+  while (!level.empty())
+    {
+      std::vector<Pending> todo;
+
+      for (const Pending &P : level)
+        if (this->seen.insert(P.name).second)
+          todo.push_back(P);
+
+      std::vector<Image> found(todo.size());
+      std::vector<char> ok(todo.size(), 0);
+      std::atomic<size_t> next(0);
+      size_t threads = worker_count(todo.size());
+
+      // only the file system and the mapped files are touched here
+      auto worker = [&]()
+        {
+          for (size_t k = next++; k < todo.size(); k = next++)
+            ok[k] = this->find(todo[k], found[k]);
+        };
+
+      std::vector<std::thread> workers;
+
+      for (size_t t = 1; t < threads; ++t)
+        workers.push_back(std::thread(worker));
+
+      if (threads)
+        worker();
+
+      for (std::thread &t : workers)
+        t.join();
+
+      size_t first = this->images.size();
+
+      for (size_t k = 0; k < todo.size(); ++k)
+        {
+          if (!ok[k])
+            {
+              this->missing.push_back(todo[k].name);
+              continue;
+            }
+
+          // the same file asked for under two names is only loaded once
+          if (!paths.insert(found[k].path).second)
+            {
+              unmap_file(found[k].map, found[k].size);
+              continue;
+            }
+
+          found[k].name = todo[k].name;
+          if (!found[k].soname.empty())
+            this->seen.insert(found[k].soname);
+
+          this->images.push_back(found[k]);
+        }
+
+      level.clear();
+      for (size_t i = first; i < this->images.size(); ++i)
+        for (const std::string &N : this->images[i].needed)
+          level.push_back(Pending{N, i});
+    }
+}
+
+SharedSymbol SharedLibs::lookup(const std::string &name) const
+{
+  SharedSymbol S;
+
+  S.found = false;
+  S.weak = false;
+  S.value = 0;
+
+  // the executable's imports are undefined in it, only the libraries
+  // are searched, the first definition wins
+  for (size_t i = 1; i < this->images.size(); ++i)
+    {
+      const Image &I = this->images[i];
+
+      if (this->lookupIn(I, name.c_str(), S))
+        {
+          S.library = I.soname.empty() ? I.name : I.soname;
+          S.path = I.path;
+          return S;
+        }
+    }
+
+  return S;
+}
+
+std::vector<SharedSymbol> SharedLibs::lookupAll(const std::vector<std::string> &names) const
+{
+  std::vector<SharedSymbol> symbols(names.size());
+  std::atomic<size_t> next(0);
+  size_t threads = worker_count(names.size());
+
+  auto worker = [&]()
+    {
+      for (size_t k = next++; k < names.size(); k = next++)
+        symbols[k] = this->lookup(names[k]);
+    };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t = 1; t < threads; ++t)
+    workers.push_back(std::thread(worker));
+
+  if (threads)
+    worker();
+
+  for (std::thread &t : workers)
+    t.join();
+
+  return symbols;
+}
+
+std::vector<std::string> SharedLibs::getLibraries() const
+{
+  std::vector<std::string> libraries;
+
+  for (size_t i = 1; i < this->images.size(); ++i)
+    libraries.push_back(this->images[i].path);
+
+  return libraries;
+}
+
+std::vector<std::string> SharedLibs::getMissing() const
+{
+  return this->missing;
+}
+
+// reads the program headers and the dynamic section of a mapped file
+template <typename Ehdr, typename Phdr, typename Dyn>
+bool SharedLibs::parse(Image &I)
+{
+  const Ehdr *eh = (const Ehdr *) I.map;
+  uint64_t phoff = ElfBytes::field(I.big, eh->e_phoff);
+  uint64_t phnum = ElfBytes::field(I.big, eh->e_phnum);
+  uint64_t phentsize = ElfBytes::field(I.big, eh->e_phentsize);
+
+  I.machine = ElfBytes::field(I.big, eh->e_machine);
+
+  if (phnum == 0)
+    return true;
+
+  if (phentsize < sizeof(Phdr) || phoff > I.size || phnum > (I.size - phoff) / phentsize)
+    return false;
+
+  std::vector<const Phdr *> loads;
+  const Phdr *dynamic = NULL;
+
+  for (uint64_t i = 0; i < phnum; ++i)
+    {
+      const Phdr *ph = (const Phdr *) (I.map + phoff + i * phentsize);
+      uint64_t type = ElfBytes::field(I.big, ph->p_type);
+
+      if (type == PT_LOAD)
+        loads.push_back(ph);
+      else if (type == PT_DYNAMIC)
+        dynamic = ph;
+    }
+
+  // a static file needs nothing and provides nothing
+  if (dynamic == NULL)
+    return true;
+
+  // the dynamic tags hold addresses, the loads tell where they are
+  auto at = [&](uint64_t vma) -> const unsigned char *
+    {
+      for (const Phdr *ph : loads)
+        {
+          uint64_t vaddr = ElfBytes::field(I.big, ph->p_vaddr);
+          uint64_t filesz = ElfBytes::field(I.big, ph->p_filesz);
+          uint64_t offset = ElfBytes::field(I.big, ph->p_offset);
+
+          if (vma >= vaddr && vma - vaddr < filesz
+              && offset <= I.size && vma - vaddr < I.size - offset)
+            return I.map + offset + (vma - vaddr);
+        }
+
+      return NULL;
+    };
+
+  uint64_t offset = ElfBytes::field(I.big, dynamic->p_offset);
+  uint64_t size = ElfBytes::field(I.big, dynamic->p_filesz);
+
+  if (offset > I.size || size > I.size - offset)
+    return false;
+
+  std::vector<uint64_t> needed;
+  uint64_t soname = (uint64_t) -1, rpath = (uint64_t) -1, runpath = (uint64_t) -1;
+  uint64_t strsz = 0;
+
+  for (uint64_t i = 0; (i + 1) * sizeof(Dyn) <= size; ++i)
+    {
+      const Dyn *d = (const Dyn *) (I.map + offset) + i;
+      uint64_t tag = ElfBytes::field(I.big, d->d_tag);
+      uint64_t val = ElfBytes::field(I.big, d->d_un.d_val);
+
+      if (tag == DT_NULL)
+        break;
+
+      switch (tag)
+        {
+        case DT_NEEDED:
+          needed.push_back(val);
+          break;
+        case DT_SONAME:
+          soname = val;
+          break;
+        case DT_RPATH:
+          rpath = val;
+          break;
+        case DT_RUNPATH:
+          runpath = val;
+          break;
+        case DT_STRTAB:
+          I.strtab = at(val);
+          break;
+        case DT_STRSZ:
+          strsz = val;
+          break;
+        case DT_SYMTAB:
+          I.symtab = at(val);
+          break;
+        case DT_HASH:
+          I.hash = at(val);
+          break;
+        case DT_GNU_HASH:
+          I.gnuhash = at(val);
+          break;
+        case DT_VERSYM:
+          I.versym = at(val);
+          break;
+        default:
+          break;
+        }
+    }
+
+  if (I.strtab == NULL)
+    return true;
+
+  I.strsz = std::min<uint64_t>(strsz, I.size - (I.strtab - I.map));
+
+  auto str = [&](uint64_t off) -> std::string
+    {
+      if (off >= I.strsz)
+        return "";
+
+      const char *s = (const char *) I.strtab + off;
+      return std::string(s, strnlen(s, I.strsz - off));
+    };
+
+  for (uint64_t N : needed)
+    I.needed.push_back(str(N));
+
+  I.soname = str(soname);
+  I.rpath = str(rpath);
+  I.runpath = str(runpath);
+
+  return true;
+}
+
+// maps a file and reads it, the file is unmapped when it isn't usable
+bool SharedLibs::open(Image &I, const std::string &path) const
+{
+  I = Image();
+  I.path = path;
+  I.map = map_file(path.c_str(), &I.size);
+
+  if (I.map == NULL)
+    return false;
+
+  bool ok = false;
+
+  if (I.size >= sizeof(Elf32_External_Ehdr)
+      && I.map[EI_MAG0] == ELFMAG0 && I.map[EI_MAG1] == ELFMAG1
+      && I.map[EI_MAG2] == ELFMAG2 && I.map[EI_MAG3] == ELFMAG3
+      && (I.map[EI_DATA] == ELFDATA2LSB || I.map[EI_DATA] == ELFDATA2MSB))
+    {
+      I.big = I.map[EI_DATA] == ELFDATA2MSB;
+
+      if (I.map[EI_CLASS] == ELFCLASS64 && I.size >= sizeof(Elf64_External_Ehdr))
+        {
+          I.is64 = true;
+          ok = parse<Elf64_External_Ehdr, Elf64_External_Phdr, Elf64_External_Dyn>(I);
+        }
+      else if (I.map[EI_CLASS] == ELFCLASS32)
+        {
+          I.is64 = false;
+          ok = parse<Elf32_External_Ehdr, Elf32_External_Phdr, Elf32_External_Dyn>(I);
+        }
+    }
+
+  if (!ok)
+    {
+      unmap_file(I.map, I.size);
+      I.map = NULL;
+      I.size = 0;
+    }
+
+  return ok;
+}
+
+// looks for a needed library in the directories its requester searches,
+// skipping files built for another machine
+bool SharedLibs::find(const Pending &P, Image &I) const
+{
+  const Image &exe = this->images[0];
+  std::vector<std::string> candidates;
+
+  if (P.name.find('/') != std::string::npos)
+    candidates.push_back(this->sysroot + (P.name[0] == '/' ? "" : "/") + P.name);
+  else
+    for (const std::string &D : this->searchDirs(this->images[P.requester]))
+      candidates.push_back(D + "/" + P.name);
+
+  for (const std::string &C : candidates)
+    {
+      if (!this->open(I, C))
+        continue;
+
+      if (I.is64 == exe.is64 && I.big == exe.big && I.machine == exe.machine)
+        return true;
+
+      unmap_file(I.map, I.size);
+      I.map = NULL;
+    }
+
+  return false;
+}
+
+// the directories ld.so would try: DT_RPATH when there is no DT_RUNPATH,
+// DT_RUNPATH, ld.so.conf, then the defaults, all under the sysroot
+std::vector<std::string> SharedLibs::searchDirs(const Image &R) const
+{
+  std::vector<std::string> dirs;
+
+  auto add = [&](const std::string &list, const Image &owner)
+    {
+      size_t start = 0;
+
+      while (start <= list.size())
+        {
+          size_t end = list.find(':', start);
+          if (end == std::string::npos)
+            end = list.size();
+
+          std::string D = list.substr(start, end - start);
+          start = end + 1;
+
+          if (D.empty())
+            continue;
+
+          // $ORIGIN is where the file was found, already under the sysroot
+          size_t origin = D.find("$ORIGIN");
+          size_t braced = D.find("${ORIGIN}");
+
+          if (origin != std::string::npos)
+            dirs.push_back(D.replace(origin, 7, dir_name(owner.path)));
+          else if (braced != std::string::npos)
+            dirs.push_back(D.replace(braced, 9, dir_name(owner.path)));
+          else
+            dirs.push_back(this->sysroot + D);
+        }
+    };
+
+  const Image &exe = this->images[0];
+
+  if (R.runpath.empty())
+    {
+      add(R.rpath, R);
+      if (&R != &exe && exe.runpath.empty())
+        add(exe.rpath, exe);
+    }
+
+  add(R.runpath, R);
+
+  for (const std::string &D : this->confDirs)
+    dirs.push_back(this->sysroot + D);
+
+  if (exe.is64)
+    {
+      dirs.push_back(this->sysroot + "/lib64");
+      dirs.push_back(this->sysroot + "/usr/lib64");
+    }
+
+  dirs.push_back(this->sysroot + "/lib");
+  dirs.push_back(this->sysroot + "/usr/lib");
+
+  return dirs;
+}
+
+// reads the directories of an ld.so.conf, following its includes
+void SharedLibs::readLdConf(const std::string &path, int depth)
+{
+  std::ifstream conf(path);
+  std::string line;
+
+  if (!conf || depth > 8)
+    return;
+
+  while (std::getline(conf, line))
+    {
+      line = line.substr(0, line.find('#'));
+
+      size_t first = line.find_first_not_of(" \t");
+      if (first == std::string::npos)
+        continue;
+
+      line = line.substr(first);
+
+      if (line.compare(0, 8, "include ") == 0 || line.compare(0, 8, "include\t") == 0)
+        {
+          std::string pattern = line.substr(8);
+          size_t from = pattern.find_first_not_of(" \t\r");
+
+          // an include with nothing after it, or only a comment
+          if (from == std::string::npos)
+            continue;
+
+          pattern = pattern.substr(from, pattern.find_last_not_of(" \t\r") + 1 - from);
+
+          if (pattern[0] == '/')
+            pattern = this->sysroot + pattern;
+          else
+            pattern = dir_name(path) + "/" + pattern;
+
+          glob_t matches;
+
+          if (glob(pattern.c_str(), 0, NULL, &matches) == 0)
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+              this->readLdConf(matches.gl_pathv[i], depth + 1);
+
+          globfree(&matches);
+          continue;
+        }
+
+      if (line.compare(0, 6, "hwcap ") == 0)
+        continue;
+
+      size_t start = 0;
+
+      while (start < line.size())
+        {
+          size_t end = line.find_first_of(" \t\r:,=", start);
+          if (end == std::string::npos)
+            end = line.size();
+
+          if (end > start && line[start] == '/')
+            this->confDirs.push_back(line.substr(start, end - start));
+
+          start = end + 1;
+        }
+    }
+}
+
+bool SharedLibs::lookupIn(const Image &I, const char *name, SharedSymbol &S) const
+{
+  if (I.symtab == NULL || I.strtab == NULL)
+    return false;
+
+  if (I.gnuhash != NULL)
+    return this->gnuLookup(I, name, S);
+
+  if (I.hash != NULL)
+    return this->sysvLookup(I, name, S);
+
+  return false;
+}
+
+// the bloom filter rejects most names without touching the buckets
+bool SharedLibs::gnuLookup(const Image &I, const char *name, SharedSymbol &S) const
+{
+  const unsigned char *p = I.gnuhash;
+
+  if (!ElfBytes::inside(I.map, I.size, p, 16))
+    return false;
+
+  uint32_t nbuckets = ElfBytes::get(p, 4, I.big);
+  uint32_t symoffset = ElfBytes::get(p + 4, 4, I.big);
+  uint32_t bloomsize = ElfBytes::get(p + 8, 4, I.big);
+  uint32_t bloomshift = ElfBytes::get(p + 12, 4, I.big);
+  size_t word = I.is64 ? 8 : 4;
+  uint32_t bits = word * 8;
+
+  if (nbuckets == 0 || bloomsize == 0)
+    return false;
+
+  const unsigned char *bloom = p + 16;
+  const unsigned char *buckets = bloom + (size_t) bloomsize * word;
+  const unsigned char *chains = buckets + (size_t) nbuckets * 4;
+
+  if (!ElfBytes::inside(I.map, I.size, bloom, (size_t) bloomsize * word + (size_t) nbuckets * 4))
+    return false;
+
+  uint32_t h = gnu_hash(name);
+  uint64_t filter = ElfBytes::get(bloom + ((h / bits) % bloomsize) * word, word, I.big);
+  uint64_t mask = ((uint64_t) 1 << (h % bits)) | ((uint64_t) 1 << ((h >> bloomshift) % bits));
+
+  if ((filter & mask) != mask)
+    return false;
+
+  uint32_t idx = ElfBytes::get(buckets + (h % nbuckets) * 4, 4, I.big);
+
+  if (idx < symoffset)
+    return false;
+
+  for (;; ++idx)
+    {
+      const unsigned char *chain = chains + (size_t) (idx - symoffset) * 4;
+
+      if (!ElfBytes::inside(I.map, I.size, chain, 4))
+        return false;
+
+      uint32_t h2 = ElfBytes::get(chain, 4, I.big);
+
+      if ((h | 1) == (h2 | 1) && this->matches(I, idx, name, S))
+        return true;
+
+      // the low bit ends the chain
+      if (h2 & 1)
+        return false;
+    }
+}
+
+bool SharedLibs::sysvLookup(const Image &I, const char *name, SharedSymbol &S) const
+{
+  const unsigned char *p = I.hash;
+
+  if (!ElfBytes::inside(I.map, I.size, p, 8))
+    return false;
+
+  uint32_t nbucket = ElfBytes::get(p, 4, I.big);
+  uint32_t nchain = ElfBytes::get(p + 4, 4, I.big);
+
+  if (nbucket == 0 || !ElfBytes::inside(I.map, I.size, p + 8, ((size_t) nbucket + nchain) * 4))
+    return false;
+
+  const unsigned char *buckets = p + 8;
+  const unsigned char *chains = buckets + (size_t) nbucket * 4;
+  uint32_t idx = ElfBytes::get(buckets + (sysv_hash(name) % nbucket) * 4, 4, I.big);
+
+  // nchain bounds the walk in case the chains loop
+  for (uint32_t n = 0; idx != 0 && idx < nchain && n < nchain; ++n)
+    {
+      if (this->matches(I, idx, name, S))
+        return true;
+
+      idx = ElfBytes::get(chains + (size_t) idx * 4, 4, I.big);
+    }
+
+  return false;
+}
+
+// a dynamic symbol is a match if it has the name and a default version
+// and defines something other libraries can bind to
+bool SharedLibs::matches(const Image &I, uint32_t idx, const char *name, SharedSymbol &S) const
+{
+  uint64_t st_name, value;
+  unsigned int info, shndx;
+
+  if (I.is64)
+    {
+      const Elf64_External_Sym *sym = (const Elf64_External_Sym *) I.symtab + idx;
+
+      if (!ElfBytes::inside(I.map, I.size, (const unsigned char *) sym, sizeof(*sym)))
+        return false;
+
+      st_name = ElfBytes::field(I.big, sym->st_name);
+      value = ElfBytes::field(I.big, sym->st_value);
+      info = ElfBytes::field(I.big, sym->st_info);
+      shndx = ElfBytes::field(I.big, sym->st_shndx);
+    }
+  else
+    {
+      const Elf32_External_Sym *sym = (const Elf32_External_Sym *) I.symtab + idx;
+
+      if (!ElfBytes::inside(I.map, I.size, (const unsigned char *) sym, sizeof(*sym)))
+        return false;
+
+      st_name = ElfBytes::field(I.big, sym->st_name);
+      value = ElfBytes::field(I.big, sym->st_value);
+      info = ElfBytes::field(I.big, sym->st_info);
+      shndx = ElfBytes::field(I.big, sym->st_shndx);
+    }
+
+  if (st_name >= I.strsz)
+    return false;
+
+  const char *sn = (const char *) I.strtab + st_name;
+  size_t len = strlen(name);
+
+  if (len >= I.strsz - st_name || memcmp(sn, name, len + 1) != 0)
+    return false;
+
+  unsigned int bind = ELF_ST_BIND(info);
+
+  if (shndx == SHN_UNDEF
+      || (bind != STB_GLOBAL && bind != STB_WEAK && bind != STB_GNU_UNIQUE))
+    return false;
+
+  // older versions of a symbol are hidden, unversioned references
+  // bind to the default one
+  if (I.versym != NULL)
+    {
+      const unsigned char *v = I.versym + (size_t) idx * 2;
+
+      if (ElfBytes::inside(I.map, I.size, v, 2))
+        {
+          unsigned int version = ElfBytes::get(v, 2, I.big);
+
+          if ((version & VERSYM_HIDDEN) || version == VER_NDX_LOCAL)
+            return false;
+        }
+    }
+
+  S.found = true;
+  S.weak = (bind == STB_WEAK);
+  S.value = value;
+
+  return true;
+}
+
+SharedLibs::SharedLibs()
+{}
+
+SharedLibs::~SharedLibs()
+{
+  for (Image &I : this->images)
+    unmap_file(I.map, I.size);
+
+  this->images.clear();
+}
@@ -0,0 +1,101 @@
+#ifndef SHAREDLIBS_H
+#define SHAREDLIBS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_set>
+
+// where a symbol the executable imports is defined
+struct SharedSymbol
+{
+  bool found;
+  bool weak;
+  std::string library;          // DT_SONAME, or the DT_NEEDED name
+  std::string path;             // the file that was read
+  uint64_t value;
+};
+
+// Finds the shared libraries an executable needs the way the dynamic
+// loader would: its DT_NEEDED entries, then theirs, breadth first, looked
+// up in DT_RPATH/DT_RUNPATH, ld.so.conf and the default directories of a
+// local sysroot. The libraries are mapped and read without bfd, one level
+// of the dependency tree at a time on several threads, and symbols are
+// looked up through each library's own .gnu.hash or .hash table.
+// Once load() returns, lookup() and lookupAll() only read.
+class SharedLibs
+{
+public:
+  void load(const std::string &, const std::string &);
+
+  SharedSymbol lookup(const std::string &) const;
+  std::vector<SharedSymbol> lookupAll(const std::vector<std::string> &) const;
+
+  // the libraries found, in search order, and the names that weren't
+  std::vector<std::string> getLibraries() const;
+  std::vector<std::string> getMissing() const;
+
+  SharedLibs();
+  SharedLibs(const SharedLibs &) = delete;
+  SharedLibs &operator=(const SharedLibs &) = delete;
+  virtual ~SharedLibs();
+
+protected:
+private:
+  // a mapped ELF file and the parts of its dynamic section used here
+  struct Image
+  {
+    std::string name;
+    std::string path;
+
+    const unsigned char *map;
+    size_t size;
+
+    bool is64;
+    bool big;
+    unsigned int machine;
+
+    const unsigned char *strtab;
+    size_t strsz;
+    const unsigned char *symtab;
+    const unsigned char *hash;
+    const unsigned char *gnuhash;
+    const unsigned char *versym;
+
+    std::string soname;
+    std::string rpath;
+    std::string runpath;
+    std::vector<std::string> needed;
+  };
+
+  // a DT_NEEDED entry waiting to be found, and who asked for it
+  struct Pending
+  {
+    std::string name;
+    size_t requester;
+  };
+
+  template <typename Ehdr, typename Phdr, typename Dyn>
+  static bool parse(Image &);
+
+  bool open(Image &, const std::string &) const;
+  bool find(const Pending &, Image &) const;
+  std::vector<std::string> searchDirs(const Image &) const;
+  void readLdConf(const std::string &, int);
+
+  bool lookupIn(const Image &, const char *, SharedSymbol &) const;
+  bool gnuLookup(const Image &, const char *, SharedSymbol &) const;
+  bool sysvLookup(const Image &, const char *, SharedSymbol &) const;
+  bool matches(const Image &, uint32_t, const char *, SharedSymbol &) const;
+
+  std::string sysroot;
+
+  // the executable first, then the libraries in load order
+  std::vector<Image> images;
+  std::vector<std::string> missing;
+  std::vector<std::string> confDirs;
+  std::unordered_set<std::string> seen;
+};
+
+#endif // SHAREDLIBS_H
@@ -4,6 +4,10 @@ Symbol::Symbol()
 {
   this->defined = false;
   this->cleared = false;
+  this->def_vma = 0;
+  this->exe_vma = 0;
+  this->placed = false;
+  this->provider_weak = false;
 }
 
 bool Symbol::isEmpty() const
@@ -28,8 +32,15 @@ bool Symbol::isFunction() const
 
 std::string Symbol::dumpExeData()
 {
+  if (!this->defined && this->provided_by.empty())
+    return "No object file or needed library defines this symbol.";
+
   if (!this->defined)
-    return "This symbols is unkown at link time. Its value will be solved at runtime.";
+    return "This symbol is resolved at runtime.\n"
+        "Provided by: " + this->provided_by + "\n"
+        "Library: " + this->provider_path + "\n"
+        "Address in library: " + this->provider_value
+        + (this->provider_weak ? " (weak)\n" : "\n");
 
   if (!this->cleared)
     this->removeExtraZeros();
@@ -33,6 +33,9 @@ public:
 
   std::vector<std::string> undefined_in;
   std::string defined_in;
+  // the path of that file and, for an archive member, the member name
+  std::string defined_path;
+  std::string defined_member;
   std::string exe_name;
 
   std::string def_value;
@@ -46,6 +49,18 @@ public:
 
   bfd_vma sz;
 
+  // numeric values of the strings above
+  bfd_vma def_vma;
+  bfd_vma exe_vma;
+  bool placed;
+
+  // the needed library the dynamic loader would bind an undefined
+  // symbol to, empty when none of them defines it
+  std::string provided_by;
+  std::string provider_path;
+  std::string provider_value;
+  bool provider_weak;
+
 private:
   void removeExtraZeros();
   bool cleared;
@@ -0,0 +1,77 @@
+#include "symbollistmodel.h"
+
+SymbolListModel::SymbolListModel(QObject *parent)
+  : QAbstractListModel(parent)
+{}
+
+SymbolListModel::~SymbolListModel()
+{}
+
+void SymbolListModel::setEntries(std::vector<Entry> newEntries)
+{
+  this->beginResetModel();
+
+  this->entries.swap(newEntries);
+  this->rows.clear();
+
+  for (size_t i = 0; i < this->entries.size(); ++i)
+    this->rows.emplace(this->entries[i].name, (int) i);
+
+  this->endResetModel();
+}
+
+void SymbolListModel::addEntries(std::vector<Entry> newEntries)
+{
+  if (newEntries.empty())
+    return;
+
+  int first = (int) this->entries.size();
+
+  this->beginInsertRows(QModelIndex(), first, first + (int) newEntries.size() - 1);
+
+  for (Entry &E : newEntries)
+    {
+      this->rows.emplace(E.name, (int) this->entries.size());
+      this->entries.push_back(std::move(E));
+    }
+
+  this->endInsertRows();
+}
+
+void SymbolListModel::clear()
+{
+  this->setEntries(std::vector<Entry>());
+}
+
+int SymbolListModel::findRow(const std::string &name) const
+{
+  auto it = this->rows.find(name);
+
+  return (it == this->rows.end()) ? -1 : it->second;
+}
+
+const SymbolListModel::Entry &SymbolListModel::entry(int row) const
+{
+  return this->entries.at(row);
+}
+
+int SymbolListModel::rowCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : (int) this->entries.size();
+}
+
+QVariant SymbolListModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || (size_t) index.row() >= this->entries.size())
+    return QVariant();
+
+  const Entry &E = this->entries[index.row()];
+
+  if (role == Qt::DisplayRole)
+    return QString::fromStdString(E.name);
+
+  if (role == Qt::ToolTipRole && !E.tooltip.empty())
+    return QString::fromStdString(E.tooltip);
+
+  return QVariant();
+}
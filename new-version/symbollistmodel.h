@@ -0,0 +1,42 @@
+#ifndef SYMBOLLISTMODEL_H
+#define SYMBOLLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// The data symbols of a file, one row each, with an optional tooltip.
+// Rows are only turned into text when a view asks for them.
+class SymbolListModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  struct Entry
+  {
+    std::string name;
+    std::string tooltip;
+  };
+
+  explicit SymbolListModel(QObject *parent = 0);
+  ~SymbolListModel();
+
+  void setEntries(std::vector<Entry>);
+  // appends rows without resetting the views
+  void addEntries(std::vector<Entry>);
+  void clear();
+
+  // the row of a symbol, or -1
+  int findRow(const std::string &) const;
+  const Entry &entry(int) const;
+
+  int rowCount(const QModelIndex & = QModelIndex()) const;
+  QVariant data(const QModelIndex &, int = Qt::DisplayRole) const;
+
+private:
+  std::vector<Entry> entries;
+  std::unordered_map<std::string, int> rows;
+};
+
+#endif // SYMBOLLISTMODEL_H
@@ -0,0 +1,399 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "elfdetective.h"
+#include "insndecoder.h"
+#include "bytetools.h"
+#include "linkermap.h"
+
+// Checks of the parts of the core that don't need a file for bfd: the
+// instruction decoder, the linker map parsers, the hex and zero scans and
+// the line alignment of the function diff. Prints every failed check and
+// exits with 1 if there was any.
+
+static int checks = 0;
+static int failures = 0;
+
+static void check(bool ok, const char *what, const char *file, int line)
+{
+  ++checks;
+
+  if (ok)
+    return;
+
+  ++failures;
+  std::cerr << file << ":" << line << ": check failed: " << what << std::endl;
+}
+
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+
+// decodes a byte string with one of the decoders, the length it returned
+// is kept in the Insn too
+static int x86(const std::string &bytes, bfd_vma vma, bool mode64, InsnDecoder::Insn *insn)
+{
+  return InsnDecoder::decode_x86((const bfd_byte *) bytes.data(), bytes.size(), vma, mode64, insn);
+}
+
+static std::string le32(unsigned long v)
+{
+  std::string s;
+
+  for (int i = 0; i < 4; ++i)
+    s += (char) ((v >> (8 * i)) & 0xff);
+
+  return s;
+}
+
+static void test_x86()
+{
+  InsnDecoder::Insn I;
+
+  // push %rbp / mov %rsp,%rbp
+  CHECK(x86("\x55", 0x1000, true, &I) == 1 && I.kind == INSN_PLAIN);
+  CHECK(x86(std::string("\x48\x89\xe5", 3), 0x1000, true, &I) == 3);
+
+  // movabs $imm64,%rax
+  CHECK(x86(std::string("\x48\xb8\x01\x02\x03\x04\x05\x06\x07\x08", 10), 0x1000, true, &I) == 10);
+
+  // call rel32, to the next instruction and backwards
+  CHECK(x86(std::string("\xe8\x00\x00\x00\x00", 5), 0x1000, true, &I) == 5);
+  CHECK(I.kind == INSN_CALL && I.target == 0x1005);
+  CHECK(x86(std::string("\xe8\xfb\xff\xff\xff", 5), 0x1000, true, &I) == 5 && I.target == 0x1000);
+
+  // jmp rel8 to itself, je rel32
+  CHECK(x86(std::string("\xeb\xfe", 2), 0x2000, true, &I) == 2);
+  CHECK(I.kind == INSN_JUMP && I.target == 0x2000);
+  CHECK(x86(std::string("\x0f\x84\x10\x00\x00\x00", 6), 0x2000, true, &I) == 6);
+  CHECK(I.kind == INSN_COND_JUMP && I.target == 0x2016);
+
+  // mov 0x10(%rip),%rax
+  CHECK(x86(std::string("\x48\x8b\x05\x10\x00\x00\x00", 7), 0x3000, true, &I) == 7);
+  CHECK((I.flags & INSN_RIPREL) && I.disp == 0x10 && I.target == 0x3017);
+
+  // ret, call *%rax, jmp *%rax
+  CHECK(x86("\xc3", 0x1000, true, &I) == 1 && I.kind == INSN_RETURN);
+  CHECK(x86(std::string("\xff\xd0", 2), 0x1000, true, &I) == 2 && I.kind == INSN_INDIRECT_CALL);
+  CHECK(x86(std::string("\xff\xe0", 2), 0x1000, true, &I) == 2 && I.kind == INSN_INDIRECT_JUMP);
+
+  // a call cut short can't be decoded
+  CHECK(x86(std::string("\xe8\x00\x00", 3), 0x1000, true, &I) == 0);
+
+  // 32-bit mode: 0x40 is inc %eax and not a REX prefix, targets wrap
+  CHECK(x86("\x40", 0x1000, false, &I) == 1);
+  CHECK(x86(std::string("\xe8") + le32(0xfffffff0), 0x8, false, &I) == 5);
+  CHECK(I.kind == INSN_CALL && I.target == 0xfffffffd);
+}
+
+static void test_aarch64()
+{
+  InsnDecoder::Insn I;
+  std::string insn;
+
+  // bl .+8
+  insn = le32(0x94000002);
+  CHECK(InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0x1000, &I) == 4);
+  CHECK(I.kind == INSN_CALL && I.target == 0x1008);
+
+  // b .-4
+  insn = le32(0x17ffffff);
+  CHECK(InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0x1000, &I) == 4);
+  CHECK(I.kind == INSN_JUMP && I.target == 0xffc);
+
+  // cbz x0, .+16
+  insn = le32(0xb4000080);
+  CHECK(InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0x1000, &I) == 4);
+  CHECK(I.kind == INSN_COND_JUMP && I.target == 0x1010);
+
+  // ret, br x1, blr x1
+  insn = le32(0xd65f03c0);
+  CHECK(InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0, &I) == 4);
+  CHECK(I.kind == INSN_RETURN);
+  insn = le32(0xd61f0020);
+  InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0, &I);
+  CHECK(I.kind == INSN_INDIRECT_JUMP);
+  insn = le32(0xd63f0020);
+  InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 4, 0, &I);
+  CHECK(I.kind == INSN_INDIRECT_CALL);
+
+  CHECK(InsnDecoder::decode_aarch64((const bfd_byte *) insn.data(), 3, 0, &I) == 0);
+}
+
+static void test_riscv()
+{
+  InsnDecoder::Insn I;
+  std::string insn;
+
+  // jal ra, .+8
+  insn = le32(0x008000ef);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 4, 0x1000, true, &I) == 4);
+  CHECK(I.kind == INSN_CALL && I.target == 0x1008);
+
+  // beq a0, a1, .-4
+  insn = le32(0xfeb50ee3);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 4, 0x1000, true, &I) == 4);
+  CHECK(I.kind == INSN_COND_JUMP && I.target == 0xffc);
+
+  // ret
+  insn = le32(0x00008067);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 4, 0, true, &I) == 4);
+  CHECK(I.kind == INSN_RETURN);
+
+  // c.j .+4, c.ret, c.nop
+  insn = std::string("\x11\xa0", 2);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 2, 0x1000, true, &I) == 2);
+  CHECK(I.kind == INSN_JUMP && I.target == 0x1004);
+  insn = std::string("\x82\x80", 2);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 2, 0, true, &I) == 2);
+  CHECK(I.kind == INSN_RETURN);
+  insn = std::string("\x01\x00", 2);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 2, 0, true, &I) == 2);
+  CHECK(I.kind == INSN_PLAIN);
+
+  // a 4 byte instruction with only 2 bytes left
+  insn = le32(0x00008067);
+  CHECK(InsnDecoder::decode_riscv((const bfd_byte *) insn.data(), 2, 0, true, &I) == 0);
+}
+
+static std::string hex(const std::vector<unsigned char> &bytes, int bpc, bool little)
+{
+  std::string out(3 * bytes.size(), '\0');
+  char *end = ByteTools::hex_encode(bytes.data(), bytes.size(), bpc, little, &out[0]);
+
+  out.resize(end - &out[0]);
+  return out;
+}
+
+static void test_bytetools()
+{
+  CHECK(hex({0x00, 0xab, 0xff}, 1, false) == "00 ab ff ");
+
+  // long enough for the vector path, and a tail after it
+  std::vector<unsigned char> bytes;
+  std::string expected;
+
+  for (int i = 0; i < 19; ++i)
+    {
+      unsigned char c = i * 15;
+
+      bytes.push_back(c);
+      expected += std::string(ByteTools::hex_pairs + 2 * c, 2) + " ";
+    }
+
+  CHECK(hex(bytes, 1, false) == expected);
+
+  // little-endian chunks are printed most significant byte first, a
+  // partial chunk at the end as it is
+  CHECK(hex({1, 2, 3, 4, 5}, 4, true) == "04 03 02 01 05 ");
+  CHECK(hex({1, 2, 3, 4}, 2, true) == "02 01 04 03 ");
+  CHECK(hex({1, 2, 3, 4}, 4, false) == "01 02 03 04 ");
+
+  std::vector<unsigned char> zeros(100, 0);
+
+  CHECK(ByteTools::find_nonzero(zeros.data(), 0, zeros.size()) == zeros.size());
+  zeros[70] = 1;
+  CHECK(ByteTools::find_nonzero(zeros.data(), 0, zeros.size()) == 70);
+  CHECK(ByteTools::find_nonzero(zeros.data(), 3, 60) == 60);
+  CHECK(ByteTools::find_nonzero(zeros.data(), 70, 71) == 70);
+  CHECK(ByteTools::find_nonzero(zeros.data(), 71, zeros.size()) == zeros.size());
+
+  // a difference under a zero mask byte doesn't count
+  std::vector<unsigned char> a(40, 7), b(40, 7), mask(40, 0xff);
+
+  CHECK(ByteTools::find_masked_mismatch(a.data(), b.data(), mask.data(), a.size()) == a.size());
+  b[20] = 8;
+  CHECK(ByteTools::find_masked_mismatch(a.data(), b.data(), mask.data(), a.size()) == 20);
+  mask[20] = 0;
+  CHECK(ByteTools::find_masked_mismatch(a.data(), b.data(), mask.data(), a.size()) == a.size());
+}
+
+// writes a map to a temporary file and loads it
+static bool load_map(LinkerMap &LM, const std::string &text)
+{
+  char path[] = "/tmp/elfdetective-testXXXXXX";
+  int fd = mkstemp(path);
+
+  if (fd < 0)
+    return false;
+
+  bool written = write(fd, text.data(), text.size()) == (ssize_t) text.size();
+  close(fd);
+
+  bool loaded = written && LM.load(path, NULL);
+  unlink(path);
+
+  return loaded;
+}
+
+static void test_gnu_ld_map()
+{
+  LinkerMap LM;
+
+  CHECK(load_map(LM,
+                 "Archive member included to satisfy reference by file (symbol)\n"
+                 "\n"
+                 "Linker script and memory map\n"
+                 "\n"
+                 "LOAD /tmp/main.o\n"
+                 "                0x0000000000400000                PROVIDE (__executable_start = 0x400000)\n"
+                 "\n"
+                 ".text           0x0000000000401000       0x40\n"
+                 " *(.text .text.*)\n"
+                 " .text          0x0000000000401000       0x20 /tmp/main.o\n"
+                 "                0x0000000000401000                main\n"
+                 " .text.a_rather_long_helper_name\n"
+                 "                0x0000000000401020       0x20 libfoo.a(helper.o)\n"
+                 "                0x0000000000401020                helper\n"
+                 "\n"
+                 ".data           0x0000000000402000        0x8\n"
+                 " .data          0x0000000000402000        0x8 /tmp/main.o\n"
+                 "                0x0000000000402000                counter\n"));
+
+  CHECK(LM.getFlavour() == MAP_GNU_LD);
+  CHECK(LM.getSectionCount() == 3);
+  CHECK(LM.getSymbolCount() == 3);
+  CHECK(LM.describe(LM.attribute(0x401004)) == "/tmp/main.o:(.text) in .text");
+  CHECK(LM.describe(LM.attribute(0x401024))
+        == "libfoo.a(helper.o):(.text.a_rather_long_helper_name) in .text");
+  CHECK(LM.describe(LM.attribute(0x402007)) == "/tmp/main.o:(.data) in .data");
+  CHECK(LM.attribute(0x401040) == NULL);
+  CHECK(LM.attribute(0x3fffff) == NULL);
+}
+
+static void test_gold_map()
+{
+  LinkerMap LM;
+
+  CHECK(load_map(LM,
+                 "Memory map\n"
+                 "\n"
+                 ".text           0x0000000000401000       0x30\n"
+                 " *(.text .stub .text.* .gnu.linkonce.t.*)\n"
+                 " .text          0x0000000000401000       0x30 main.o\n"
+                 "                0x0000000000401000                main\n"
+                 " ** fill        0x0000000000401030        0x0\n"));
+
+  CHECK(LM.getFlavour() == MAP_GOLD);
+  CHECK(LM.getSectionCount() == 1);
+  CHECK(LM.getSymbolCount() == 1);
+  CHECK(LM.describe(LM.attribute(0x40102f)) == "main.o:(.text) in .text");
+  CHECK(LM.attribute(0x401030) == NULL);
+}
+
+static void test_lld_map()
+{
+  LinkerMap LM;
+
+  CHECK(load_map(LM,
+                 "             VMA              LMA     Size Align Out     In      Symbol\n"
+                 "          2011c8           2011c8       2c     4 .text\n"
+                 "          2011c8           2011c8       20     4         main.o:(.text)\n"
+                 "          2011c8           2011c8        0     1                 main\n"
+                 "          2011e8           2011e8        c     4         lib.a(util.o):(.text.util)\n"
+                 "          2011e8           2011e8        0     1                 util\n"
+                 "          2011f4           2011f4        0     1                 end = .\n"));
+
+  CHECK(LM.getFlavour() == MAP_LLD);
+  CHECK(LM.getSectionCount() == 2);
+  CHECK(LM.getSymbolCount() == 2);
+  CHECK(LM.describe(LM.attribute(0x2011c8)) == "main.o:(.text) in .text");
+  CHECK(LM.describe(LM.attribute(0x2011f3)) == "lib.a(util.o):(.text.util) in .text");
+  CHECK(LM.attribute(0x2011f4) == NULL);
+}
+
+static void test_unknown_map()
+{
+  LinkerMap LM;
+
+  CHECK(!load_map(LM, "not a map\n"));
+  CHECK(LM.getFlavour() == MAP_UNKNOWN);
+}
+
+static CodeLine *line_at(bfd_vma vma, int length)
+{
+  CodeLine *c = new CodeLine();
+
+  c->setVma(vma);
+  c->setLength(length);
+
+  return c;
+}
+
+static void test_diff_align()
+{
+  // the executable has an instruction at 4 the object doesn't, the object
+  // one at 5; the rest pair up by offset whatever the start addresses
+  std::vector<CodeLine *> exe = {line_at(0x401000, 1), line_at(0x401001, 3),
+                                 line_at(0x401004, 4), line_at(0x401008, 1)};
+  std::vector<CodeLine *> obj = {line_at(0x0, 1), line_at(0x1, 4),
+                                 line_at(0x5, 3), line_at(0x8, 1)};
+  std::vector<LineDiff> diff = FunctionDiff::align(exe, 0x401000, obj, 0);
+
+  CHECK(diff.size() == 5);
+
+  if (diff.size() == 5)
+    {
+      CHECK(diff[0].offset == 0 && diff[0].exeLine == 0 && diff[0].objLine == 0);
+      CHECK(diff[0].status == DIFF_MATCH);
+      CHECK(diff[1].offset == 1 && diff[1].exeLine == 1 && diff[1].objLine == 1);
+      CHECK(diff[2].offset == 4 && diff[2].exeLine == 2 && diff[2].objLine == -1);
+      CHECK(diff[2].status == DIFF_MISSING);
+      CHECK(diff[3].offset == 5 && diff[3].exeLine == -1 && diff[3].objLine == 2);
+      CHECK(diff[3].status == DIFF_MISSING);
+      CHECK(diff[4].offset == 8 && diff[4].exeLine == 3 && diff[4].objLine == 3);
+    }
+
+  // a side without lines leaves every line of the other one missing
+  diff = FunctionDiff::align(exe, 0x401000, std::vector<CodeLine *>(), 0);
+  CHECK(diff.size() == exe.size());
+  CHECK(diff.back().status == DIFF_MISSING && diff.back().objLine == -1);
+
+  for (CodeLine *c : exe)
+    delete c;
+  for (CodeLine *c : obj)
+    delete c;
+}
+
+static void test_diff_statics()
+{
+  // two objects define a static helper 0x20 into their .text, each one is
+  // compared to the copy its own section was moved to
+  asection textA = asection();
+  asection textB = asection();
+  std::unordered_map<asection *, bfd_vma> placedA = {{&textA, 0x401000}};
+  std::unordered_map<asection *, bfd_vma> placedB = {{&textB, 0x401180}};
+
+  CHECK(FunctionDiff::exeAddress(&textA, 0x20, placedA, nullptr) == 0x401020);
+  CHECK(FunctionDiff::exeAddress(&textB, 0x20, placedB, nullptr) == 0x4011a0);
+
+  // a local in a section no global placed has nowhere to go
+  CHECK(FunctionDiff::exeAddress(&textB, 0x20, placedA, nullptr) == (bfd_vma) -1);
+
+  // a global there goes where the binding put it
+  Symbol S;
+  S.exe_vma = 0x402000;
+  CHECK(FunctionDiff::exeAddress(&textB, 0, placedA, &S) == (bfd_vma) -1);
+  S.placed = true;
+  CHECK(FunctionDiff::exeAddress(&textB, 0, placedA, &S) == 0x402000);
+}
+
+int main()
+{
+  test_x86();
+  test_aarch64();
+  test_riscv();
+  test_bytetools();
+  test_gnu_ld_map();
+  test_gold_map();
+  test_lld_map();
+  test_unknown_map();
+  test_diff_align();
+  test_diff_statics();
+
+  std::cout << checks - failures << "/" << checks << " checks passed" << std::endl;
+
+  return failures ? 1 : 0;
+}
@@ -1,3 +1,10 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+
 #include "tools.h"
 
 /* Error reporting.  */
@@ -160,6 +167,78 @@ off_t get_file_size(const char * file_name)
   return (off_t) -1;
 }
 
+/* Maps FILE_NAME read only.  The pages are shared with the page cache,
+   so several threads can read the same file without copying it.  */
+
+const unsigned char *map_file(const char * file_name, size_t *size)
+{
+  struct stat statbuf;
+  void *map;
+  int fd;
+
+  *size = 0;
+
+  fd = open(file_name, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  if (fstat(fd, &statbuf) < 0 || statbuf.st_size <= 0)
+    {
+      close(fd);
+      return NULL;
+    }
+
+  map = mmap(NULL, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (map == MAP_FAILED)
+    return NULL;
+
+  *size = statbuf.st_size;
+  return (const unsigned char *) map;
+}
+
+void unmap_file(const unsigned char *map, size_t size)
+{
+  if (map != NULL)
+    munmap((void *) map, size);
+}
+
+static std::atomic<size_t> workers_wanted(0);
+
+size_t worker_count(size_t jobs)
+{
+  size_t threads = workers_wanted.load();
+
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  if (threads > jobs)
+    threads = jobs;
+
+  return threads;
+}
+
+void set_worker_count(size_t threads)
+{
+  workers_wanted = threads;
+}
+
+std::recursive_mutex &bfd_lock()
+{
+  static std::recursive_mutex lock;
+
+  return lock;
+}
+
+void init_core()
+{
+  static std::once_flag done;
+
+  std::call_once(done, []() {bfd_init();});
+}
+
 /* After a FALSE return from bfd_check_format_matches with
    bfd_get_error () == bfd_error_file_ambiguously_recognized, print
    the possible matching targets.  */
@@ -300,3 +379,177 @@ int compare_symbols(const void *ap, const void *bp)
        get consistent results by sorting the symbols by name.  */
   return strcmp(an, bn);
 }
+
+/* Everything compare_symbols looks at, computed once per symbol.  The
+   tie breakers that come after the section are packed into FLAGS so that
+   a smaller value sorts first.  */
+
+struct symbol_sort_key
+{
+  bfd_vma value;
+  unsigned int section;
+  unsigned int flags;
+  const char *name;
+  asymbol *sym;
+};
+
+static const unsigned int SORT_DOT_NAME = 0x01;
+static const unsigned int SORT_NOT_GLOBAL = 0x02;
+static const unsigned int SORT_LOCAL = 0x04;
+static const unsigned int SORT_NOT_FUNCTION = 0x08;
+static const unsigned int SORT_DEBUGGING = 0x10;
+static const unsigned int SORT_FILE = 0x20;
+static const unsigned int SORT_COMPILED = 0x40;
+
+static unsigned int symbol_sort_flags(const asymbol *sym, const char *name)
+{
+  size_t len = strlen(name);
+  unsigned int flags = 0;
+
+  if (strstr(name, "gnu_compiled") != NULL
+      || strstr(name, "gcc2_compiled") != NULL)
+    flags |= SORT_COMPILED;
+
+  if ((sym->flags & BSF_FILE) != 0
+      || (len >= 2 && name[len - 2] == '.'
+          && (name[len - 1] == 'o' || name[len - 1] == 'a')))
+    flags |= SORT_FILE;
+
+  if ((sym->flags & BSF_DEBUGGING) != 0)
+    flags |= SORT_DEBUGGING;
+  if ((sym->flags & BSF_FUNCTION) == 0)
+    flags |= SORT_NOT_FUNCTION;
+  if ((sym->flags & BSF_LOCAL) != 0)
+    flags |= SORT_LOCAL;
+  if ((sym->flags & BSF_GLOBAL) == 0)
+    flags |= SORT_NOT_GLOBAL;
+  if (name[0] == '.')
+    flags |= SORT_DOT_NAME;
+
+  return flags;
+}
+
+void sort_symbols(asymbol **symbols, long count)
+{
+  if (count < 2)
+    return;
+
+  /* compare_symbols orders sections by their address in memory, so the
+     section ordinals follow the same order.  */
+  std::vector<asection *> sections;
+
+  for (long i = 0; i < count; ++i)
+    sections.push_back(symbols[i]->section);
+
+  std::sort(sections.begin(), sections.end());
+  sections.erase(std::unique(sections.begin(), sections.end()), sections.end());
+
+  std::vector<symbol_sort_key> keys(count);
+  size_t threads = worker_count((size_t) count / 4096 + 1);
+  std::vector<std::thread> workers;
+
+  for (size_t t = 0; t < threads; ++t)
+    workers.push_back(std::thread([&, t]()
+      {
+        for (long i = count * t / threads; i < (long) (count * (t + 1) / threads); ++i)
+          {
+            asymbol *sym = symbols[i];
+            symbol_sort_key &key = keys[i];
+
+            key.value = bfd_asymbol_value(sym);
+            key.section = std::lower_bound(sections.begin(), sections.end(),
+                                           sym->section) - sections.begin();
+            key.name = bfd_asymbol_name(sym);
+            key.flags = symbol_sort_flags(sym, key.name);
+            key.sym = sym;
+          }
+      }));
+
+  for (std::thread &t : workers)
+    t.join();
+
+  /* Only symbols equal in everything else get their names compared.  */
+  parallel_sort(keys, [](const symbol_sort_key &a, const symbol_sort_key &b)
+    {
+      if (a.value != b.value)
+        return a.value < b.value;
+      if (a.section != b.section)
+        return a.section < b.section;
+      if (a.flags != b.flags)
+        return a.flags < b.flags;
+
+      return strcmp(a.name, b.name) < 0;
+    });
+
+  for (long i = 0; i < count; ++i)
+    symbols[i] = keys[i].sym;
+}
+
+struct reloc_sort_key
+{
+  bfd_vma address;
+  arelent *rel;
+};
+
+void sort_relocs(arelent **relocs, long count)
+{
+  if (count < 2)
+    return;
+
+  std::vector<reloc_sort_key> keys(count);
+
+  for (long i = 0; i < count; ++i)
+    {
+      keys[i].address = relocs[i]->address;
+      keys[i].rel = relocs[i];
+    }
+
+  /* Relocations at the same address are ordered by their arelent
+     pointers, as they always were.  */
+  parallel_sort(keys, [](const reloc_sort_key &a, const reloc_sort_key &b)
+    {
+      if (a.address != b.address)
+        return a.address < b.address;
+
+      return a.rel < b.rel;
+    });
+
+  for (long i = 0; i < count; ++i)
+    relocs[i] = keys[i].rel;
+}
+
+std::string json_string(const std::string &s)
+{
+  std::string out = "\"";
+
+  for (char c : s)
+    {
+      switch (c)
+        {
+        case '"':
+          out += "\\\"";
+          break;
+        case '\\':
+          out += "\\\\";
+          break;
+        case '\n':
+          out += "\\n";
+          break;
+        case '\t':
+          out += "\\t";
+          break;
+        default:
+          if ((unsigned char) c < 0x20)
+            {
+              char buf[8];
+
+              snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char) c);
+              out += buf;
+            }
+          else
+            out += c;
+        }
+    }
+
+  return out + "\"";
+}
@@ -2,6 +2,10 @@
 #define TOOLS_H
 
 #include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cassert>
@@ -57,8 +61,78 @@ void list_matching_formats(char **);
 
 off_t get_file_size(const char *);
 
+/* Maps a whole file read only, the size is stored in *SIZE.  Returns
+   NULL if the file can't be mapped.  */
+const unsigned char *map_file(const char *, size_t *);
+
+void unmap_file(const unsigned char *, size_t);
+
+/* Threads a parallel loop over JOBS items uses: one per core unless
+   set_worker_count chose another number, and never more than JOBS.  */
+size_t worker_count(size_t);
+
+/* 0 goes back to one thread per core.  */
+void set_worker_count(size_t);
+
+/* S as a quoted JSON string, for the tools printing JSON lines.  */
+std::string json_string(const std::string &);
+
+/* bfd keeps global state (its cache of open files, the last error), so
+   every entry point of the core that reaches it holds this lock.  It is
+   recursive since the entry points call one another.  */
+std::recursive_mutex &bfd_lock();
+
+/* Calls bfd_init, once, from whichever thread gets here first.  */
+void init_core();
+
 extern void *bfd_malloc(bfd_size_type);
 
 int compare_symbols(const void *, const void *);
 
+/* Sorts SYMBOLS in the same order compare_symbols gives, from keys
+   computed once per symbol.  */
+void sort_symbols(asymbol **, long);
+
+/* Sorts relocations by address.  */
+void sort_relocs(arelent **, long);
+
+/* Sorts V using up to worker_count threads: every thread sorts one
+   slice, then the slices are merged pairwise.  */
+template <typename T, typename Compare>
+void parallel_sort(std::vector<T> &v, Compare cmp)
+{
+  const size_t min_slice = 1 << 16;
+  size_t threads = worker_count(v.size() / min_slice);
+
+  if (threads < 2)
+    {
+      std::sort(v.begin(), v.end(), cmp);
+      return;
+    }
+
+  std::vector<size_t> bounds;
+  std::vector<std::thread> workers;
+
+  for (size_t i = 0; i <= threads; ++i)
+    bounds.push_back(v.size() * i / threads);
+
+  for (size_t i = 0; i < threads; ++i)
+    workers.push_back(std::thread([&v, &bounds, cmp, i]()
+      {
+        std::sort(v.begin() + bounds[i], v.begin() + bounds[i + 1], cmp);
+      }));
+
+  for (std::thread &t : workers)
+    t.join();
+
+  for (size_t width = 1; width < threads; width *= 2)
+    for (size_t i = 0; i + width < threads; i += 2 * width)
+      {
+        size_t last = std::min(i + 2 * width, threads);
+
+        std::inplace_merge(v.begin() + bounds[i], v.begin() + bounds[i + width],
+                           v.begin() + bounds[last], cmp);
+      }
+}
+
 #endif // TOOLS_H
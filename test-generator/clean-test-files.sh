@@ -1,3 +1,4 @@
 #!/bin/bash
 
 rm test_file*
+rm -rf benchmark-corpora benchmark-results.jsonl
@@ -0,0 +1,115 @@
+#!/usr/bin/python
+
+# ./compare-benchmarks.py RESULTS BASELINE [--threshold [PHASE=]FRACTION]... [--min-ms MS] [--update]
+#
+# Both files hold a line of JSON per project, as elfdetective-bench writes
+# them. A phase regresses when it takes more than its threshold longer
+# than in the baseline (0.10 is 10%) and at least --min-ms more, so the
+# short phases of small projects don't fail on noise. --update makes the
+# results the new baseline.
+
+from __future__ import print_function
+
+import sys
+import json
+import shutil
+
+PHASES = ["load_ms", "bind_ms", "disassemble_ms", "populate_ms"]
+
+DEFAULT_THRESHOLD = 0.10
+DEFAULT_MIN_MS = 5.0
+
+def usage():
+	print("Usage: compare-benchmarks.py RESULTS BASELINE [--threshold [PHASE=]FRACTION]..."
+		  " [--min-ms MS] [--update]", file=sys.stderr)
+	sys.exit(2)
+
+def load(path):
+	projects = {}
+
+	with open(path) as f:
+		for line in f:
+			if line.strip():
+				p = json.loads(line)
+				projects[p['name']] = p
+
+	return projects
+
+def main(args):
+	thresholds = dict((phase, DEFAULT_THRESHOLD) for phase in PHASES)
+	min_ms = DEFAULT_MIN_MS
+	update = False
+	files = []
+
+	i = 0
+	while i < len(args):
+		if args[i] == "--threshold" and i + 1 < len(args):
+			value = args[i + 1]
+
+			# a phase can be named with or without its _ms
+			if "=" in value:
+				phase, value = value.split("=", 1)
+				if not phase.endswith("_ms"):
+					phase += "_ms"
+				if phase not in PHASES:
+					usage()
+				thresholds[phase] = float(value)
+			else:
+				for phase in PHASES:
+					thresholds[phase] = float(value)
+			i += 2
+		elif args[i] == "--min-ms" and i + 1 < len(args):
+			min_ms = float(args[i + 1])
+			i += 2
+		elif args[i] == "--update":
+			update = True
+			i += 1
+		else:
+			files.append(args[i])
+			i += 1
+
+	if len(files) != 2:
+		usage()
+
+	results_path, baseline_path = files
+
+	if update:
+		shutil.copyfile(results_path, baseline_path)
+		print("Baseline updated from", results_path)
+		return 0
+
+	results = load(results_path)
+
+	try:
+		baseline = load(baseline_path)
+	except IOError:
+		print("No baseline in", baseline_path + ", run again with --update to record one")
+		return 0
+
+	regressions = 0
+
+	for name in sorted(results, key=lambda n: results[n]['objects']):
+		if name not in baseline:
+			print(name + ": not in the baseline")
+			continue
+
+		for phase in PHASES:
+			now = float(results[name][phase])
+			before = float(baseline[name][phase])
+			change = (now - before) / before if before > 0 else 0.0
+			failed = change > thresholds[phase] and now - before >= min_ms
+
+			print("%-14s %-16s %10.1f ms %10.1f ms %+7.1f%%%s" %
+				  (name, phase, before, now, change * 100,
+				   "  REGRESSION" if failed else ""))
+
+			if failed:
+				regressions += 1
+
+	if regressions:
+		print(regressions, "phases regressed")
+		return 1
+
+	return 0
+
+sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# builds a project of every size in benchmark-corpora/SIZE, the same
+# files every time since the size is also the seed
+SIZES=${SIZES:-"10 100 1000 10000"}
+HERE=$(cd "$(dirname "$0")" && pwd)
+
+for n in $SIZES
+do
+	dir=benchmark-corpora/$n
+
+	if [ -x "$dir/test_file" ]; then
+		continue
+	fi
+
+	mkdir -p "$dir"
+	(
+		cd "$dir" &&
+		"$HERE/test-generator.py" "$n" "$n" &&
+		ls test_file*.c | xargs -P "$(nproc)" -n 50 gcc -fno-builtin -w -c &&
+		ls test_file*.o > objects.list &&
+		gcc test_file*.o -o test_file
+	) || exit 1
+done
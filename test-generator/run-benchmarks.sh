@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# ./run-benchmarks.sh path/to/elfdetective-bench [extra compare-benchmarks.py options]
+# times every corpus, JOBS sets the worker threads, then compares the
+# results with benchmark-baseline.jsonl
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 elfdetective-bench [--threshold [PHASE=]FRACTION] [--min-ms MS] [--update]"
+	exit 2
+fi
+
+SIZES=${SIZES:-"10 100 1000 10000"}
+BENCH=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+RESULTS=$(pwd)/benchmark-results.jsonl
+shift
+
+SIZES="$SIZES" ./generate-benchmark-corpora.sh || exit 1
+
+rm -f "$RESULTS"
+
+for n in $SIZES
+do
+	(
+		cd "benchmark-corpora/$n" &&
+		"$BENCH" -j "${JOBS:-0}" -n "corpus-$n" -o "$RESULTS" test_file @objects.list
+	) || exit 1
+done
+
+./compare-benchmarks.py "$RESULTS" benchmark-baseline.jsonl "$@"
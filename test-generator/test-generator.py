@@ -22,6 +22,20 @@ FUNCTION = 1
 
 generated_main = False
 
+# large projects only pull in this many external symbols per file and
+# per function, so the sources grow with the number of files, not its square
+MAX_EXTERNALS = 32
+
+# names the generator must not pick: every C keyword, the GNU ones and
+# the ones C23 added, and main
+reserved = Set(["asm", "auto", "bool", "break", "case", "char", "const",
+				"continue", "default", "do", "double", "else", "enum", "extern",
+				"false", "float", "for", "goto", "if", "inline", "int", "long",
+				"main", "nullptr", "register", "restrict", "return", "short",
+				"signed", "sizeof", "static", "struct", "switch", "true",
+				"typedef", "typeof", "union", "unsigned", "void", "volatile",
+				"while"])
+
 unique_symbols	 = Set()
 external_symbols = []
 used_ext_symbols = []
@@ -46,7 +60,7 @@ def generate_symbols(file_no, is_function = False):
 
 	for i in range(symbols_no):
 		sym = randomword(randint(2,5))
-		while sym in unique_symbols:
+		while sym in unique_symbols or sym in reserved:
 			sym = randomword(randint(2,5))
 
 		file_symbols.append({
@@ -58,18 +72,29 @@ def generate_symbols(file_no, is_function = False):
 
 	return file_symbols
 
+# the external symbols another file than file_no offers that match keep,
+# out of a random sample when there are too many to look through
+def pick_externals(file_no, keep):
+	candidates = external_symbols
+
+	if len(candidates) > MAX_EXTERNALS * 2:
+		candidates = random.sample(candidates, MAX_EXTERNALS * 2)
+
+	picked = filter(lambda sym: sym['File'] != file_no and keep(sym), candidates)
+
+	return picked[:MAX_EXTERNALS]
+
 def generate_functions(file, function):
 	syms = generate_symbols(function['File'], True)
 
-	ext_symbols = filter(lambda sym: sym['File'] != function['File'] and \
-									sym['Type'] == FUNCTION,
-									external_symbols)
+	ext_symbols = pick_externals(function['File'],
+								 lambda sym: sym['Type'] == FUNCTION)
 
 	ext_symbols.extend(used_ext_symbols[function['File']])
 
 	# no need to use that many symbols in a single function
 	symbols_no 	= randint(0, len(ext_symbols) / 3)
-	start_index = randint(0, len(ext_symbols) - symbols_no - 1)
+	start_index = randint(0, max(0, len(ext_symbols) - symbols_no - 1))
 
 	file.write((int_type if function['Name'] == "main" else void_type) + \
 				" " + function['Name'] + parenthesis + \
@@ -105,8 +130,7 @@ def generate_file(file_no):
 
 	file.write("\n")
 
-	init_syms = filter(lambda sym: sym['File'] != file_no and \
-								sym['Keyword'] == external, external_symbols)
+	init_syms = pick_externals(file_no, lambda sym: sym['Keyword'] == external)
 
 	used_ext_symbols.append(init_syms)
 
@@ -133,7 +157,11 @@ def generate_file(file_no):
 	file.close()
 
 def start():
-	files_no = randint(2,4)
+	# ./test-generator.py [FILES [SEED]]
+	if len(sys.argv) > 2:
+		random.seed(int(sys.argv[2]))
+
+	files_no = int(sys.argv[1]) if len(sys.argv) > 1 else randint(2,4)
 
 	# generate symbols for each file
 	for i in range(files_no):